@@ -0,0 +1,98 @@
+#include "admission_control.h"
+
+#include <algorithm>
+
+#include "metrics.h"
+
+namespace {
+using namespace std::literals;
+
+constexpr std::string_view REJECT_BODY = R"({"code":"serviceUnavailable","message":"Server is overloaded, retry later"})";
+
+bool EndsWith(std::string_view text, std::string_view suffix) {
+    return text.size() >= suffix.size() && text.substr(text.size() - suffix.size()) == suffix;
+}
+
+std::string_view GetPriorityName(http_server::AdmissionControl::Priority priority) {
+    using Priority = http_server::AdmissionControl::Priority;
+    switch (priority) {
+        case Priority::LOW: return "low"sv;
+        case Priority::NORMAL: return "normal"sv;
+        case Priority::HIGH: return "high"sv;
+    }
+    return {};
+}
+
+// Счетчики общего экземпляра видны в /metrics
+http_server::AdmissionControl& RegisterMetrics(http_server::AdmissionControl& control) {
+    auto& registry = metrics::Registry::Instance();
+    registry.AddCallbackGauge("http_connections", "Open HTTP connections", [&control] { return double(control.Connections()); });
+    registry.AddCallbackGauge("api_strand_pending", "API requests waiting for the game strand", [&control] { return double(control.Pending()); });
+    return control;
+}
+
+}  // namespace
+
+namespace http_server {
+
+AdmissionControl& AdmissionControl::Instance() {
+    static AdmissionControl control;
+    static AdmissionControl& registered = RegisterMetrics(control);
+    return registered;
+}
+
+void AdmissionControl::Configure(const Limits& limits) {
+    limits_ = limits;
+    auto retry_after = std::to_string(limits_.retry_after.count());
+    connection_reject_ = std::make_shared<const std::string>(
+        "HTTP/1.1 503 Service Unavailable\r\n"s + "Retry-After: "s + retry_after + "\r\nContent-Type: application/json\r\nCache-Control: no-cache\r\n"s +
+        "Content-Length: "s + std::to_string(REJECT_BODY.size()) + "\r\nConnection: close\r\n\r\n"s + std::string(REJECT_BODY));
+}
+
+bool AdmissionControl::TryAcquireConnection() {
+    auto connections = connections_.fetch_add(1, std::memory_order_relaxed);
+    if (limits_.max_connections == 0 || connections < limits_.max_connections) 
+        return true;
+    connections_.fetch_sub(1, std::memory_order_relaxed);
+    CountRejected("connections"sv, Priority::HIGH);
+    return false;
+}
+
+bool AdmissionControl::TryEnterQueue(Priority priority) {
+    auto pending = pending_.fetch_add(1, std::memory_order_relaxed);
+    if (limits_.max_pending == 0 || pending < QueueLimit(priority)) 
+        return true;
+    pending_.fetch_sub(1, std::memory_order_relaxed);
+    CountRejected("pending"sv, priority);
+    return false;
+}
+
+bool AdmissionControl::Admit(Priority priority) {
+    if (limits_.max_pending == 0 || Pending() < QueueLimit(priority)) 
+        return true;
+    CountRejected("pending"sv, priority);
+    return false;
+}
+
+AdmissionControl::Priority AdmissionControl::ClassifyRoute(std::string_view pattern) {
+    if (EndsWith(pattern, "/player/action"sv) || EndsWith(pattern, "/state"sv)) 
+        return Priority::HIGH;
+    if (EndsWith(pattern, "/records"sv)) 
+        return Priority::LOW;
+    return Priority::NORMAL;
+}
+
+size_t AdmissionControl::QueueLimit(Priority priority) const noexcept {
+    switch (priority) {
+        case Priority::LOW: return std::max<size_t>(1, limits_.max_pending / 2);
+        case Priority::NORMAL: return std::max<size_t>(1, limits_.max_pending * 3 / 4);
+        case Priority::HIGH: return limits_.max_pending;
+    }
+    return limits_.max_pending;
+}
+
+void AdmissionControl::CountRejected(std::string_view reason, Priority priority) {
+    metrics::RejectedRequests().WithLabels({reason, GetPriorityName(priority)}).Inc();
+}
+
+}  // namespace http_server
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+////////////////////////////////////////////////
+//// Ограничение нагрузки: при перегрузке сервер быстро отвечает 503,
+//// а не копит очередь, в которой ждут все
+////////////////////////////////////////////////
+
+namespace http_server {
+
+class AdmissionControl {
+   public:
+    // Чем выше приоритет, тем большая часть очереди strand ему доступна
+    enum class Priority {
+        LOW,     // статика и таблица рекордов - не более половины очереди
+        NORMAL,  // остальные запросы API - три четверти очереди
+        HIGH,    // игровой процесс: действия игрока и состояние - вся очередь
+    };
+
+    struct Limits {
+        // 0 - без ограничения
+        size_t max_connections = 0;
+        size_t max_pending = 0;
+        std::chrono::seconds retry_after{1};
+    };
+
+    // Общий для сервера экземпляр, его счетчики видны в /metrics
+    static AdmissionControl& Instance();
+
+    AdmissionControl() { Configure({}); }
+
+    // Только до запуска сервера
+    void Configure(const Limits& limits);
+    const Limits& GetLimits() const noexcept { return limits_; }
+
+    // Вызывается только из Listener. Соединение освобождается в ReleaseConnection
+    bool TryAcquireConnection();
+    void ReleaseConnection() noexcept { connections_.fetch_sub(1, std::memory_order_relaxed); }
+
+    // Запрос ждет своей очереди на strand API до LeaveQueue
+    bool TryEnterQueue(Priority priority);
+    void LeaveQueue() noexcept { pending_.fetch_sub(1, std::memory_order_relaxed); }
+    // Для работы вне strand (статика): пропустить, пока очередь strand не слишком длинная
+    bool Admit(Priority priority);
+
+    size_t Connections() const noexcept { return connections_.load(std::memory_order_relaxed); }
+    size_t Pending() const noexcept { return pending_.load(std::memory_order_relaxed); }
+
+    // Готовый ответ 503 для соединений сверх лимита, до разбора запроса
+    std::shared_ptr<const std::string> ConnectionRejectResponse() const { return connection_reject_; }
+
+    static Priority ClassifyRoute(std::string_view pattern);
+
+   private:
+    size_t QueueLimit(Priority priority) const noexcept;
+    void CountRejected(std::string_view reason, Priority priority);
+
+    Limits limits_;
+    std::shared_ptr<const std::string> connection_reject_;
+    std::atomic<size_t> connections_ = 0;
+    std::atomic<size_t> pending_ = 0;
+};
+
+}  // namespace http_server
@@ -1,18 +1,26 @@
 #pragma once
 
 #include <boost/asio.hpp>
-#include <map>
+#include <functional>
 #include <memory>
 
 #include "headers.h"
 #include "model.h"
+#include "router.h"
+
+namespace http_server {
+class WebSocketSession;
+}
 
 namespace api {
 
 namespace net = boost::asio;
 using version_code_t = size_t;
-using Args_t = std::deque<std::string_view>;
 using api_handler_t = std::function<void(HttpResource&&)>;
+using upgrade_handler_t = std::function<void(const StringRequest&, const router::Params&, std::shared_ptr<http_server::WebSocketSession>)>;
+
+using Routes = router::Router<api_handler_t>;
+using UpgradeRoutes = router::Router<upgrade_handler_t>;
 
 class ApiCommon {
    public:
@@ -20,7 +28,8 @@ class ApiCommon {
 
     explicit ApiCommon(strand_t & strand) : strand_(strand){};
 
-    virtual void HandleApi(HttpResource&& resp) = 0;
+    // Регистрирует все методы версии под префиксом вида "/api/v1"
+    virtual void RegisterRoutes(std::string_view prefix, Routes& routes, UpgradeRoutes& upgrade_routes) = 0;
 
     virtual int GetVersionCode() = 0;
     static std::string GetContentTypeString(api::ApiCommon::TypeData type);
@@ -29,4 +38,4 @@ class ApiCommon {
     strand_t & strand_;
 };
 
-}  // namespace api
\ No newline at end of file
+}  // namespace api
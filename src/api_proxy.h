@@ -2,8 +2,7 @@
 
 #include "api_v1.h"
 
-// Хранит все версии API и подгружает если версия API понадобилась
-// Возможен сброс кэша по таймауту если API давно не использовалось
+// Хранит все версии API и регистрирует их маршруты
 // TODO Пока что сразу все загружает, по мере расширения добавить
 namespace api {
 
@@ -13,13 +12,11 @@ class ApiProxyKeeper {
    public:
     ApiProxyKeeper(strand_t & strand, app::App &);
 
-    std::shared_ptr<const ApiCommon> GetConstApiByVersion(std::string_view) const;
-    std::shared_ptr<ApiCommon> GetMutableApiByVersion(std::string_view) const;
+    // Каждая версия получает префикс "/api/v<код версии>"
+    void RegisterRoutes(Routes& routes, UpgradeRoutes& upgrade_routes) const;
 
    private:
-    std::shared_ptr<ApiCommon> getApiByCode(version_code_t code) const noexcept;
-
     std::map<version_code_t, std::shared_ptr<ApiCommon> > apis_;
 };
 
-}  // namespace api
\ No newline at end of file
+}  // namespace api
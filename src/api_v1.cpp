@@ -2,9 +2,12 @@
 
 #include <boost/asio/strand.hpp>
 
+#include "admission_control.h"
 #include "common.h"
 #include "error_codes.h"
+#include "json_request.h"
 #include "logger.h"
+#include "state_encoder.h"
 
 namespace {
 namespace http = boost::beast::http;
@@ -15,67 +18,41 @@ using ec = http_handler::ErrorCode;
 
 namespace api_v1 {
 
-Api::Api(strand_t& strand, app::App& app) : ApiCommon(strand) {
-    api_classes_["maps"] = std::make_unique<Maps>(app);
-    api_classes_["game"] = std::make_unique<Game>(app);
-}
+Api::Api(strand_t& strand, app::App& app) : ApiCommon(strand), app_(app), broadcaster_(strand, app), game_(strand, app, broadcaster_), maps_(app) {}
 
 int Api::GetVersionCode() { return 0x1; }
 
-void Api::HandleApi(HttpResource&& res) {
-    if (res.args.empty()) 
-        throw ec::BAD_REQUEST;
-    auto val = util::ExtractArg(res.args);
+void Api::RegisterRoutes(std::string_view prefix, api::Routes& routes, api::UpgradeRoutes& upgrade_routes) {
+    std::string base(prefix);
+    game_.RegisterRoutes(base + "/game"s, routes);
+    maps_.RegisterRoutes(base + "/maps"s, routes);
 
-    auto it = api_classes_.find(val);
-    if (it == api_classes_.end()) 
-        throw ec::BAD_REQUEST;
+    // ws://.../api/v1/game/state?token=... , браузер не умеет выставлять Authorization для WebSocket
+    upgrade_routes.Add(http::verb::get, base + "/game/state"s,
+                       [this](const StringRequest& req, const router::Params& params, std::shared_ptr<http_server::WebSocketSession> ws) {
+                           HandleWebSocket(req, params, std::move(ws));
+                       });
+}
 
-    auto& redirect = it;
+void Api::HandleWebSocket(const StringRequest& req, const router::Params& params, std::shared_ptr<http_server::WebSocketSession> ws) {
+    auto token_raw = util::ToSV(req[http::field::authorization]);
+    if (token_raw.empty()) 
+        token_raw = util::GetQueryParam(params.Query(), "token"sv).value_or(""sv);
+    if (token_raw.empty()) 
+        throw ec::AUTHORIZATION_NOT_EXIST;
 
-    HttpResource copy = res;
-    if (!redirect->second->RedirectAutomatic(std::move(res))) 
-        throw method_handler::MakeAllowError(std::move(copy), redirect->second.get());
+    broadcaster_.Subscribe(util::CreateTokenByAuthorizationString(token_raw), req, std::move(ws));
 }
 
 //////// GAME ///////////
 
-bool Game::GetHandler(HttpResource&& res, bool is_ping) {
-    if (res.args.size() == 1) {
-        auto arg = util::ExtractArg(res.args);
-        if (arg == "players"sv) {
-            CALL_WITH_PING(is_ping, GetPlayers(std::move(res)))
-        }
-        if (arg == "state"sv) {
-            CALL_WITH_PING(is_ping, GetState(std::move(res)))
-        }
-        if (arg.substr(0,7) == "records"sv) {
-            
-            CALL_WITH_PING(is_ping, GetRecords(arg, std::move(res)))
-        }
-    }
-    return false;
-}
-
-bool Game::PostHandler(HttpResource&& res, bool is_ping) {
-    if (res.args.size() == 1) {
-            auto arg = util::ExtractArg(res.args);
-        if (arg == "join"sv) { 
-            CALL_WITH_PING(is_ping, AddNewPlayer(std::move(res)));
-        }
-        if (arg == "tick"sv) {
-            CALL_WITH_PING(is_ping, Tick(std::move(res)));
-        }
-    } else if (res.args.size() == 2) {
-        auto arg = util::ExtractArg(res.args);
-        if (arg == "player"sv) {
-            auto arg = util::ExtractArg(res.args);
-            if (arg == "action") {
-                CALL_WITH_PING(is_ping, MovePlayer(std::move(res)))
-            }
-        }
-    }
-    return false;
+void Game::RegisterRoutes(const std::string& prefix, api::Routes& routes) {
+    routes.Add(http::verb::get, prefix + "/players"s, [this](HttpResource&& res) { GetPlayers(std::move(res)); });
+    routes.Add(http::verb::get, prefix + "/state"s, [this](HttpResource&& res) { GetState(std::move(res)); });
+    routes.Add(http::verb::get, prefix + "/records"s, [this](HttpResource&& res) { GetRecords(std::move(res)); });
+    routes.Add(http::verb::post, prefix + "/join"s, [this](HttpResource&& res) { AddNewPlayer(std::move(res)); });
+    routes.Add(http::verb::post, prefix + "/tick"s, [this](HttpResource&& res) { Tick(std::move(res)); });
+    routes.Add(http::verb::post, prefix + "/player/action"s, [this](HttpResource&& res) { MovePlayer(std::move(res)); });
 }
 
 void Game::AddNewPlayer(HttpResource&& res) {
@@ -87,9 +64,9 @@ void Game::AddNewPlayer(HttpResource&& res) {
     std::string name, map_id;
 
     try {
-        auto tree = json_loader::JsonObject::GetTree(res.req.body());
-        name = tree.get<std::string>("userName");
-        map_id = tree.get<std::string>("mapId");
+        json_loader::RequestFields fields(res.req.body());
+        name = fields.Get("userName");
+        map_id = fields.Get("mapId");
     } catch (...) {
         throw ec::JOIN_PLAYER_UNKNOWN;
     }
@@ -98,7 +75,9 @@ void Game::AddNewPlayer(HttpResource&& res) {
     if (!player) 
         throw ec::JOIN_PLAYER_UNKNOWN;
 
-    auto json = json_loader::CreateTrivialJson({"authToken", "playerId"}, *token, *player->dog_->GetId());
+    std::array<char, util::TOKEN_SIZE> hex;
+    util::TokenToHex(token, hex);
+    auto json = json_loader::CreateTrivialJson({"authToken", "playerId"}, std::string(hex.data(), hex.size()), *player->dog_->GetId());
 
     util::FillBody(res.resp, json_loader::JsonObject::GetJson(json, false));
 }
@@ -127,11 +106,11 @@ void Game::MovePlayer(HttpResource&& res) {
 
     auto token_raw = util::ExecuteAuthorized(res);
 
-    std::string_view move;
+    std::string move;
 
     try {
-        auto tree = json_loader::JsonObject::GetTree(res.req.body());
-        move = tree.get<std::string>("move");
+        json_loader::RequestFields fields(res.req.body());
+        move = fields.Get("move");
     } catch (...) {
         throw ec::BAD_REQUEST;
     }
@@ -150,8 +129,8 @@ void Game::Tick(HttpResource&& res) {
 
     int time_delta;
     try {
-        auto tree = json_loader::JsonObject::GetTree(res.req.body());
-        time_delta = atoi(tree.get<std::string>("timeDelta").c_str());
+        json_loader::RequestFields fields(res.req.body());
+        time_delta = atoi(fields.Get("timeDelta").c_str());
     } catch (...) {
         throw ec::BAD_REQUEST_TICK;
     }
@@ -166,16 +145,15 @@ void Game::Tick(HttpResource&& res) {
 
 //////// MAPS ///////////
 
-bool Maps::GetHandler(HttpResource&& res, bool is_ping) {
-    res.resp.set(http::field::content_type, util::ToBSV(ContentType::JSON));
-
-    if (res.args.empty()) {
-        CALL_WITH_PING(is_ping, util::FillBody(res.resp, GetMapListJson()))
-    } else if (res.args.size() == 1) {
-        CALL_WITH_PING(is_ping, util::FillBody(res.resp, GetMapDescriptionJson(res.args.back())));
-    }
-
-    return false;
+void Maps::RegisterRoutes(const std::string& prefix, api::Routes& routes) {
+    routes.Add(http::verb::get, prefix, [this](HttpResource&& res) {
+        res.resp.set(http::field::content_type, util::ToBSV(ContentType::JSON));
+        util::FillBody(res.resp, GetMapListJson());
+    });
+    routes.Add(http::verb::get, prefix + "/{id}"s, [this](HttpResource&& res) {
+        res.resp.set(http::field::content_type, util::ToBSV(ContentType::JSON));
+        util::FillBody(res.resp, GetMapDescriptionJson(res.params[0]));
+    });
 }
 
 std::string Maps::GetMapListJson() const { return app_.GetGame().GetJsonMaps(); }
@@ -188,108 +166,83 @@ std::string Maps::GetMapDescriptionJson(std::string_view id) const {
 }
 
 void Game::GetState(HttpResource&& res) const {
-    res.resp.set(http::field::content_type, res.req[http::field::content_type]);
+    // Формат ответа выбирается по Accept, JSON по умолчанию
+    auto format = NegotiateStateFormat(util::ToSV(res.req[http::field::accept]));
+    if (format == StateFormat::BINARY) 
+        res.resp.set(http::field::content_type, util::ToBSV(GetStateContentType(format)));
+    else 
+        res.resp.set(http::field::content_type, res.req[http::field::content_type]);
     res.resp.set(http::field::cache_control, "no-cache");
+    res.resp.set(http::field::vary, "Accept");
 
     auto token_raw = util::ExecuteAuthorized(res);
-    auto token = util::CreateTokenByAuthorizationString(token_raw);
-    const auto & dogs = app_.GetPlayers().GetListDogInRoom(token);
-    const auto & loot_objects = app_.GetPlayers().FindByToken(token)->session_->GetLootObjects();
-
-    //Из-за проблем с Json и точностью на тестах пока что про число с плавающей точкой обрабатываются данным образом
-    //В дальнешем найти алтеранативу или совсем убрать округление кординат когда тесты пройдут
-    auto ROUND_VALUE_FOR_TEST = [](double value) -> double {
-        return std::round(value * std::pow(10, 6)) / std::pow(10, 6);
-    };
-
-    auto CreateRoundedNode = [&](boost::property_tree::ptree & node, auto & value) -> boost::property_tree::ptree  {
-
-        if (fmod(value, 1.0) != 0.0) {
-            node.push_back({"", boost::property_tree::ptree().put("", ROUND_VALUE_FOR_TEST(value))});
-        } else {
-            node.push_back({"", boost::property_tree::ptree().put("", std::to_string(int(value)) + "f")});
-        }
-
-        return node;
-    };
-
-    ptree main_json;  // TODO продумать как кастомные json файлы можно применить к системе модели
-    ptree list_dogs_json;
-    for (const auto& dog : dogs) {
-        ptree dog_json;
-
-        boost::property_tree::ptree pos_pt;
-        CreateRoundedNode(pos_pt, dog->GetPosition().x);
-        CreateRoundedNode(pos_pt, dog->GetPosition().y);
-
-        boost::property_tree::ptree speed_pt;
-        CreateRoundedNode(speed_pt, dog->GetSpeed().x);
-        CreateRoundedNode(speed_pt, dog->GetSpeed().y);
-
-        boost::property_tree::ptree bag;
-        for(const auto [id, loot] : dog->GetMutableBag().items) {
-            ptree bag_node;
-            bag_node.put("id", id);
-            bag_node.put("type", loot);
-            bag.push_back({"",bag_node});
-        }
-        if (bag.empty()) 
-            bag.push_back(std::make_pair("", boost::property_tree::ptree()));
-            
-        dog_json.add_child("pos", pos_pt);
-        dog_json.add_child("speed", speed_pt);
-        dog_json.put("dir", dog->GetDirectionChar());
-        dog_json.add_child("bag",bag);
-        dog_json.put("score",dog->GetScore());
-
-        list_dogs_json.add_child(std::to_string(*dog->GetId()) + "S"s, dog_json);
+    auto player = app_.GetPlayers().GetPlayerWithCheck(util::CreateTokenByAuthorizationString(token_raw));
+
+    // ?wait=1 - ответ придет после следующего тика сессии (long-poll)
+    if (util::GetQueryParam(res.params.Query(), "wait"sv) == "1"sv && res.req.method() == http::verb::get) {
+        auto send = res.deferred.Take();
+        broadcaster_.WaitNextTick(player->session_, [resp = std::move(res.resp), send = std::move(send), format](StateSnapshot& snapshot) mutable {
+            util::FillBody(resp, *snapshot.Get(format));
+            send(std::move(resp));
+        });
+        return;
     }
-    main_json.add_child("players", list_dogs_json);
 
-    ptree objects_list_json;
-    for (const auto& loot_object : loot_objects) {
-        ptree obj_json;
-
-        boost::property_tree::ptree pos_pt;
-        CreateRoundedNode(pos_pt, loot_object->GetPosition().x);
-        CreateRoundedNode(pos_pt, loot_object->GetPosition().y);
-
-        obj_json.put("type", loot_object->GetType());
-        obj_json.add_child("pos", pos_pt);
-        objects_list_json.add_child(std::to_string(loot_object->GetId()) + "S"s, obj_json);
-    }
-    main_json.add_child("lostObjects", objects_list_json);
-
-    util::FillBody(res.resp, json_loader::JsonObject::GetJson(main_json, false));
+    util::FillBody(res.resp, EncodeState(*player->session_, format));
 }
 
-void Game::GetRecords(const std::string_view & url, HttpResource && res) const {
+void Game::GetRecords(HttpResource && res) const {
     res.resp.set(http::field::content_type, util::ToBSV(ContentType::JSON));
     res.resp.set(http::field::cache_control, "no-cache");
 
-    auto properties = util::GetPropertiesFromUrl(std::string(url.data(), url.size()));
-
-    auto offset = properties.contains("start") ? atoi(properties["start"].c_str()) : 0;
-    auto maxItems = properties.contains("maxItems") ? atoi(properties["maxItems"].c_str()) : 100;
+    auto query = res.params.Query();
+    auto offset = util::GetQueryParamInt(query, "start"sv, 0);
+    auto maxItems = util::GetQueryParamInt(query, "maxItems"sv, 100);
+    auto after = util::GetQueryParam(query, "after"sv);
 
-    if(maxItems > 100)
+    if(maxItems > 100 || maxItems < 0 || offset < 0 || (after && offset != 0))
         throw ec::BAD_REQUEST;
 
-    auto players_list = app_.GetUseCaseDB().GetPlayersRetired(offset, maxItems);
+    std::optional<app::RetiredPlayerInfo> last;
+    if(after) {
+        last = app::DecodeRecordsCursor(*after);
+        if(!last) 
+            throw ec::BAD_REQUEST;
+    }
 
-    std::string response_string = "[";
-    for(const auto & player : players_list) {
-        ptree player_json;
-        player_json.put("name", player.name_);
-        player_json.put("score", player.score_);
-        player_json.put("playTime", player.play_time_ms_ / 1000.0);
-        response_string += json_loader::JsonObject::GetJson(player_json, false) +",\n"s;
+    auto respond = [](StringResponse & resp, const app::RecordsPage & page) {
+        if(!page.next_cursor.empty()) 
+            resp.set("X-Next-Cursor", util::ToBSV(page.next_cursor));
+        util::FillBody(resp, page.json);
+    };
+
+    // Первые страницы отдаются из памяти, в БД идут только за глубокими.
+    // С курсором after БД читает индекс с нужного места, без пропуска offset строк
+    const auto & leaderboard = app_.GetLeaderboard();
+    if(auto page = last ? leaderboard.PageAfter(*last, maxItems) : leaderboard.Page(offset, maxItems)) {
+        respond(res.resp, *page);
+        return;
     }
-    if(response_string.size() != 1) 
-        response_string.erase(response_string.size()-2,1);//','
-    response_string += "]";
 
-    util::FillBody(res.resp, response_string);
+    // Запрос идет в пуле БД, strand API тем временем обслуживает игру. Тело ответа на HEAD очищает отправитель
+    auto reply = [resp = std::move(res.resp), send = res.deferred.Take(), maxItems, respond]
+                 (app::AsyncUseCases::Status status, app::UseCases::players_list_t players) mutable {
+        using Status = app::AsyncUseCases::Status;
+        if(status == Status::OK) {
+            respond(resp, app::Leaderboard::EncodePage(players, maxItems));
+        } else if(status == Status::FAILED) {
+            http_handler::FillInfoError(resp, ec::UNKNOWN_ERROR);
+        } else {
+            http_handler::FillInfoError(resp, ec::SERVICE_UNAVAILABLE);
+            resp.set(http::field::retry_after, std::to_string(http_server::AdmissionControl::Instance().GetLimits().retry_after.count()));
+        }
+        send(std::move(resp));
+    };
+    auto & async_db = app_.GetAsyncUseCaseDB();
+    if(last) 
+        async_db.GetPlayersRetiredAfter(*last, maxItems, strand_, std::move(reply));
+    else 
+        async_db.GetPlayersRetired(offset, maxItems, strand_, std::move(reply));
 }
 
 }  // namespace api_v1
\ No newline at end of file
@@ -2,21 +2,19 @@
 
 #include "api.h"
 #include "app.h"
-#include "method_handler.h"
 #include "model.h"
+#include "state_broadcaster.h"
 #include <mutex>
 
 namespace api_v1 {
 
 namespace net = boost::asio;
-using Methods = method_handler::MethodHandler;
 
-class Game : public Methods {
+class Game {
    public:
-    explicit Game(app::App &app) : Methods(app) {}
+    Game(strand_t &strand, app::App &app, StateBroadcaster &broadcaster) : strand_(strand), app_(app), broadcaster_(broadcaster) {}
 
-    bool GetHandler(HttpResource &&, bool is_ping = false) override;
-    bool PostHandler(HttpResource &&, bool is_ping = false) override;
+    void RegisterRoutes(const std::string &prefix, api::Routes &routes);
 
    private:
     void AddNewPlayer(HttpResource &&);
@@ -25,18 +23,24 @@ class Game : public Methods {
 
     void GetPlayers(HttpResource &&) const;
     void GetState(HttpResource &&res) const;
-    void GetRecords(const std::string_view & url, HttpResource &&res) const;
+    void GetRecords(HttpResource &&res) const;
+
+    strand_t &strand_;
+    app::App &app_;
+    StateBroadcaster &broadcaster_;
 };
 
-class Maps : public Methods {
+class Maps {
    public:
-    explicit Maps(app::App &app) : Methods(app) {}
+    explicit Maps(app::App &app) : app_(app) {}
 
-    bool GetHandler(HttpResource &&, bool is_ping = false) override;
+    void RegisterRoutes(const std::string &prefix, api::Routes &routes);
 
    private:
     std::string GetMapListJson() const;
     std::string GetMapDescriptionJson(std::string_view) const;
+
+    app::App &app_;
 };
 
 class Api : public api::ApiCommon {
@@ -44,10 +48,15 @@ class Api : public api::ApiCommon {
     Api(strand_t &strand, app::App &app);
 
     int GetVersionCode() override;
-    void HandleApi(HttpResource && resp) override;
+    void RegisterRoutes(std::string_view prefix, api::Routes &routes, api::UpgradeRoutes &upgrade_routes) override;
 
    private:
-    std::map<std::string, std::unique_ptr<Methods>, std::less<> > api_classes_;
+    void HandleWebSocket(const StringRequest &req, const router::Params &params, std::shared_ptr<http_server::WebSocketSession> ws);
+
+    app::App &app_;
+    StateBroadcaster broadcaster_;
+    Game game_;
+    Maps maps_;
 };
 
 }  // namespace api_v1
\ No newline at end of file
@@ -1,14 +1,36 @@
 #include "app.h"
 
+#include "token_minter.h"
+
 namespace app {
 
-App::App(const std::filesystem::path& settings_json, const std::string & db_url) 
+namespace {
+
+std::unique_ptr<UseCases> MakeUseCases(postgres::Database * database, const RecordsStorage & storage) {
+    if (database) 
+        return std::make_unique<UseCasesImpl>(*database);
+    return std::make_unique<UseCasesMemory>(storage.file);
+}
+
+}  // namespace
+
+App::App(const std::filesystem::path& settings_json, const RecordsStorage & storage,
+         boost::asio::any_io_executor db_executor, AsyncUseCases::Limits db_limits) 
 : game_(settings_json)
 , players_(game_)
 , tick_edit_access_(false)
-, database_(db_url) {
+, database_(storage.db_url.empty() ? nullptr : std::make_unique<postgres::Database>(storage.db_url, storage.db_pool))
+, use_case_db(MakeUseCases(database_.get(), storage))
+, async_use_case_db_(*use_case_db, std::move(db_executor), db_limits) {
+    leaderboard_.Warm(use_case_db->GetPlayersRetired(0, static_cast<int>(leaderboard_.Capacity())));
+
     game_.request_to_save_retired_player_s.connect(
-        [this](const std::string & a1, int a2, int a3){use_case_db.AddPlayerRetired({a1,a2,a3});}
+        [this](const std::string & a1, int a2, int a3){
+            // Таблица рекордов в памяти обновляется сразу, БД - в фоне. id общий, чтобы курсоры совпадали
+            RetiredPlayerInfo player{a1, a2, a3, util::GenerateRandomUuid()};
+            leaderboard_.Add(player);
+            async_use_case_db_.AddPlayerRetired(std::move(player));
+        }
     );
 };
 
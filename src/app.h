@@ -1,16 +1,32 @@
 #pragma once
 
+#include <boost/asio/any_io_executor.hpp>
+
+#include "async_use_cases.h"
+#include "leaderboard.h"
 #include "players.h"
 
 #include "use_case_impl_db.h"
+#include "use_case_impl_memory.h"
 #include "postgres.h"
 
 namespace app {
 
+// Где хранится таблица рекордов
+struct RecordsStorage {
+    // Пусто - в памяти процесса, без Postgres
+    std::string db_url;
+    postgres::ConnectionPool::Limits db_pool;
+    // Только для хранения в памяти: файл для дописывания записей, пусто - без сохранения
+    std::filesystem::path file;
+};
+
 // Facade
 class App {
    public:
-    explicit App(const std::filesystem::path& settings_json, const std::string & db_url);
+    // db_executor - пул потоков для запросов к БД, чтобы они не задерживали тик и strand API
+    App(const std::filesystem::path& settings_json, const RecordsStorage & storage,
+        boost::asio::any_io_executor db_executor, AsyncUseCases::Limits db_limits = {});
 
     const Players& GetPlayers() const { return players_; }
     Players& GetMutablePlayers() { return players_; }
@@ -18,15 +34,20 @@ class App {
     const model::Game& GetGame() const { return game_; }
     model::Game& GetMutableGame() { return game_; }
 
-    UseCases & GetUseCaseDB() { return use_case_db; }
+    UseCases & GetUseCaseDB() { return *use_case_db; }
+    AsyncUseCases & GetAsyncUseCaseDB() { return async_use_case_db_; }
+    const Leaderboard & GetLeaderboard() const { return leaderboard_; }
 
     void SetTickEditAccess(bool is_open) { tick_edit_access_ = is_open; }
     bool GetTickEditAccess() { return tick_edit_access_; }
 
    private:
 
-    postgres::Database database_;
-    UseCasesImpl use_case_db{database_};
+    // nullptr при хранении в памяти
+    std::unique_ptr<postgres::Database> database_;
+    std::unique_ptr<UseCases> use_case_db;
+    AsyncUseCases async_use_case_db_;
+    Leaderboard leaderboard_;
 
     model::Game game_;
     Players players_;
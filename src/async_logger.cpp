@@ -0,0 +1,346 @@
+#include "async_logger.h"
+
+#include <algorithm>
+#include <boost/date_time/c_local_time_adjustor.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+using namespace std::literals;
+
+constexpr size_t FLUSH_SIZE = 64 * 1024;
+constexpr auto IDLE_WAIT = 100ms;
+
+// Экранирование как у write_json из boost::property_tree
+void AppendEscaped(std::string& out, std::string_view text) {
+    static constexpr char HEX[] = "0123456789ABCDEF";
+    for (char c : text) {
+        switch (c) {
+            case '"': out += "\\\""sv; break;
+            case '\\': out += "\\\\"sv; break;
+            case '/': out += "\\/"sv; break;
+            case '\b': out += "\\b"sv; break;
+            case '\f': out += "\\f"sv; break;
+            case '\n': out += "\\n"sv; break;
+            case '\r': out += "\\r"sv; break;
+            case '\t': out += "\\t"sv; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out += "\\u00"sv;
+                    out += HEX[(c >> 4) & 0xF];
+                    out += HEX[c & 0xF];
+                } else {
+                    out += c;
+                }
+        }
+    }
+}
+
+template <typename T>
+void AppendNumber(std::string& out, T value) {
+    char buffer[32];
+    auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, end);
+}
+
+// Локальное время как у атрибута TimeStamp из add_common_attributes
+std::string FormatTimestamp(int64_t time_us) {
+    using namespace boost::posix_time;
+    ptime utc = from_time_t(static_cast<std::time_t>(time_us / 1'000'000)) + microseconds(time_us % 1'000'000);
+    return to_iso_extended_string(boost::date_time::c_local_adjustor<ptime>::utc_to_local(utc));
+}
+
+int64_t NowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void WriteStdout(std::string_view text) {
+    std::fwrite(text.data(), 1, text.size(), stdout);
+    std::fflush(stdout);
+}
+
+constexpr std::string_view CATEGORY_NAMES[] = {"server"sv, "request"sv, "response"sv, "network"sv};
+constexpr std::string_view LEVEL_NAMES[] = {"trace"sv, "debug"sv, "info"sv, "warning"sv, "error"sv, "fatal"sv};
+
+template <size_t N>
+size_t FindName(const std::string_view (&names)[N], std::string_view name, std::string_view what) {
+    for (size_t i = 0; i < N; ++i)
+        if (names[i] == name)
+            return i;
+    throw std::invalid_argument("unknown log "s + std::string(what) + ": "s + std::string(name));
+}
+
+}  // namespace
+
+namespace async_logger {
+
+Filter& Filter::Instance() {
+    static Filter filter;
+    return filter;
+}
+
+bool Filter::Sample(Category category) const noexcept {
+    auto every = sampling_[Index(category)].load(std::memory_order_relaxed);
+    if (every <= 1)
+        return true;
+    thread_local std::array<uint32_t, static_cast<size_t>(Category::COUNT)> counters{};
+    return ++counters[Index(category)] % every == 0;
+}
+
+void Filter::Reset() noexcept {
+    for (size_t i = 0; i < levels_.size(); ++i) {
+        levels_[i].store(Level::INFO, std::memory_order_relaxed);
+        sampling_[i].store(1, std::memory_order_relaxed);
+    }
+    SetSlowRequest(DEFAULT_SLOW_REQUEST);
+}
+
+void Filter::EnableAll() noexcept {
+    for (size_t i = 0; i < levels_.size(); ++i) {
+        levels_[i].store(Level::TRACE, std::memory_order_relaxed);
+        sampling_[i].store(1, std::memory_order_relaxed);
+    }
+}
+
+void Filter::Apply(std::string_view config, bool reset) {
+    struct Setting {
+        Category category;
+        Level level;
+        uint32_t every;
+    };
+    std::vector<Setting> settings;
+    std::optional<int64_t> slow_request_ms;
+
+    std::istringstream input{std::string(config)};
+    for (std::string line; std::getline(input, line);) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream words(line);
+        std::string name, value;
+        if (!(words >> name))
+            continue;
+        if (!(words >> value))
+            throw std::invalid_argument("missing value for "s + name);
+
+        if (name == "slow-request-ms"sv) {
+            slow_request_ms = std::stoll(value);
+            continue;
+        }
+        Setting setting{static_cast<Category>(FindName(CATEGORY_NAMES, name, "category"sv)),
+                        static_cast<Level>(FindName(LEVEL_NAMES, value, "level"sv)), 1};
+        if (std::string every; words >> every)
+            setting.every = static_cast<uint32_t>(std::stoul(every));
+        settings.push_back(setting);
+    }
+
+    // Сброс только после разбора всего файла, иначе ошибка в нем откатила бы настройки
+    if (reset)
+        Reset();
+    for (const auto& setting : settings) {
+        SetLevel(setting.category, setting.level);
+        SetSampling(setting.category, setting.every);
+    }
+    if (slow_request_ms)
+        SetSlowRequest(std::chrono::milliseconds(*slow_request_ms));
+}
+
+void AppendJson(std::string& out, const Record& record) {
+    std::string_view text = record.overflow ? std::string_view(*record.overflow) : std::string_view(record.text.data(), record.text_size);
+    if (record.raw) {
+        // Formatter Boost.Log сам добавляет перевод строки
+        out += text;
+        if (text.empty() || text.back() != '\n')
+            out += '\n';
+        return;
+    }
+
+    out += "{\"timestamp\":\""sv;
+    out += FormatTimestamp(record.time_us);
+    out += "\",\"data\":"sv;
+    if (record.field_count == 0) {
+        out += "\"\""sv;
+    } else {
+        out += '{';
+        for (size_t i = 0; i < record.field_count; ++i) {
+            const auto& field = record.fields[i];
+            if (i > 0)
+                out += ',';
+            out += '"';
+            AppendEscaped(out, field.name);
+            out += "\":"sv;
+            switch (field.type) {
+                case Field::Type::INT: AppendNumber(out, field.int_value); break;
+                case Field::Type::UINT: AppendNumber(out, field.uint_value); break;
+                case Field::Type::DOUBLE: AppendNumber(out, field.double_value); break;
+                case Field::Type::BOOL: out += field.bool_value ? "true"sv : "false"sv; break;
+                case Field::Type::STRING:
+                    out += '"';
+                    AppendEscaped(out, text.substr(field.text.offset, field.text.size));
+                    out += '"';
+                    break;
+            }
+        }
+        out += '}';
+    }
+    out += ",\"message\":\""sv;
+    AppendEscaped(out, text.substr(0, record.message_size));
+    out += "\"}\n"sv;
+}
+
+Logger& Logger::Instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::~Logger() {
+    Stop();
+    while (queue_.TryPop([](const Record& record) { delete record.overflow; })) {
+    }
+}
+
+void Logger::Start(Sink sink) {
+    if (thread_.joinable())
+        return;
+    sink_ = sink ? std::move(sink) : Sink(&WriteStdout);
+    stopping_ = false;
+    thread_ = std::thread([this] { Run(); });
+}
+
+void Logger::Stop() {
+    if (!thread_.joinable())
+        return;
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    wakeup_.notify_one();
+    thread_.join();
+}
+
+template <typename Fill>
+void Logger::Push(Fill&& fill) {
+    // Очередь полна - даем потоку журнала время разобрать ее, но запрос долго не держим
+    for (int attempt = 0; !queue_.TryPush(fill); ++attempt) {
+        if (attempt == BACKPRESSURE_SPINS) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            dropped_total_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        std::this_thread::yield();
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed)) {
+        std::lock_guard lock(mutex_);
+        wakeup_.notify_one();
+    }
+}
+
+void Logger::Log(std::string_view message, std::initializer_list<Field> fields) {
+    auto time_us = NowUs();
+    Push([&](Record& record) {
+        record.time_us = time_us;
+        record.raw = false;
+        record.overflow = nullptr;
+
+        // Строки не помещаются целиком - обрезаются, запись важнее полноты
+        size_t used = 0;
+        auto put_text = [&](std::string_view text) {
+            size_t size = std::min(text.size(), Record::TEXT_SIZE - used);
+            std::copy_n(text.data(), size, record.text.data() + used);
+            used += size;
+            return static_cast<uint16_t>(size);
+        };
+        record.message_size = put_text(message);
+
+        size_t count = 0;
+        for (const auto& field : fields) {
+            if (count == Record::MAX_FIELDS)
+                break;
+            auto& stored = record.fields[count++];
+            stored.name = field.name_;
+            stored.type = field.type_;
+            switch (field.type_) {
+                case Field::Type::INT: stored.int_value = field.int_; break;
+                case Field::Type::UINT: stored.uint_value = field.uint_; break;
+                case Field::Type::DOUBLE: stored.double_value = field.double_; break;
+                case Field::Type::BOOL: stored.bool_value = field.bool_; break;
+                case Field::Type::STRING:
+                    stored.text.offset = static_cast<uint16_t>(used);
+                    stored.text.size = put_text(field.string_);
+                    break;
+            }
+        }
+        record.field_count = static_cast<uint8_t>(count);
+        record.text_size = static_cast<uint16_t>(used);
+    });
+}
+
+void Logger::LogRaw(std::string_view line) {
+    auto time_us = NowUs();
+    // Если запись выброшена из-за переполнения очереди, строка освобождается здесь же
+    std::unique_ptr<std::string> overflow;
+    if (line.size() > Record::TEXT_SIZE)
+        overflow = std::make_unique<std::string>(line);
+    Push([&](Record& record) {
+        record.time_us = time_us;
+        record.raw = true;
+        record.field_count = 0;
+        record.message_size = 0;
+        record.overflow = overflow.release();
+        record.text_size = record.overflow ? 0 : static_cast<uint16_t>(line.size());
+        std::copy_n(line.data(), record.text_size, record.text.data());
+    });
+}
+
+size_t Logger::Drain(std::string& out) {
+    size_t count = 0;
+    while (out.size() < FLUSH_SIZE && queue_.TryPop([&out](const Record& record) {
+               AppendJson(out, record);
+               delete record.overflow;
+           }))
+        ++count;
+
+    if (auto dropped = dropped_.exchange(0, std::memory_order_relaxed); dropped > 0) {
+        Record record{};
+        record.time_us = NowUs();
+        record.fields[0].name = "dropped";
+        record.fields[0].type = Field::Type::UINT;
+        record.fields[0].uint_value = dropped;
+        record.field_count = 1;
+        constexpr auto message = "log records dropped"sv;
+        std::copy(message.begin(), message.end(), record.text.begin());
+        record.message_size = record.text_size = message.size();
+        AppendJson(out, record);
+    }
+    return count;
+}
+
+void Logger::Run() {
+    std::string buffer;
+    buffer.reserve(FLUSH_SIZE * 2);
+    while (true) {
+        auto count = Drain(buffer);
+        if (!buffer.empty()) {
+            sink_(buffer);
+            buffer.clear();
+            written_.fetch_add(count, std::memory_order_relaxed);
+            continue;
+        }
+
+        std::unique_lock lock(mutex_);
+        if (stopping_ && queue_.Empty())
+            break;
+        sleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (queue_.Empty() && !stopping_)
+            wakeup_.wait_for(lock, IDLE_WAIT);
+        sleeping_.store(false, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace async_logger
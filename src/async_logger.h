@@ -0,0 +1,274 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+////////////////////////////////////////////////
+//// Асинхронный журнал: потоки сервера только кладут компактную
+//// запись в кольцевую очередь, JSON собирает отдельный поток
+////////////////////////////////////////////////
+
+namespace async_logger {
+
+// Ограниченная очередь многие писатели - один читатель без блокировок (Д. Вьюков).
+// Каждая ячейка хранит номер позиции, по нему писатель понимает, что ячейка свободна,
+// а читатель - что запись в нее завершена
+template <typename T, size_t Capacity>
+class MpscRing {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+   public:
+    MpscRing() : slots_(std::make_unique<Slot[]>(Capacity)) {
+        for (size_t i = 0; i < Capacity; ++i)
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    // fill(T&) вызывается уже для захваченной ячейки. false - очередь заполнена
+    template <typename Fill>
+    bool TryPush(Fill&& fill) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots_[pos & (Capacity - 1)];
+            auto diff = static_cast<intptr_t>(slot.sequence.load(std::memory_order_acquire)) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    fill(slot.value);
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Только для потока-читателя. consume(const T&) получает запись прямо из ячейки
+    template <typename Consume>
+    bool TryPop(Consume&& consume) {
+        Slot& slot = slots_[dequeue_pos_ & (Capacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1)
+            return false;
+        consume(static_cast<const T&>(slot.value));
+        slot.sequence.store(dequeue_pos_ + Capacity, std::memory_order_release);
+        ++dequeue_pos_;
+        return true;
+    }
+
+    bool Empty() const {
+        return slots_[dequeue_pos_ & (Capacity - 1)].sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1;
+    }
+
+   private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    alignas(64) std::atomic<size_t> enqueue_pos_ = 0;
+    alignas(64) size_t dequeue_pos_ = 0;
+};
+
+// Уровни совпадают с boost::log::trivial::severity_level
+enum class Level : uint8_t { TRACE, DEBUG, INFO, WARNING, ERROR, FATAL };
+
+enum class Category : uint8_t {
+    SERVER,    // записи Boost.Log: запуск, остановка, отладка модели и БД
+    REQUEST,   // "request received"
+    RESPONSE,  // "response sent"
+    NETWORK,   // ошибки сокетов
+    COUNT
+};
+
+// Уровни и выборка по категориям. Меняются на лету из любого потока (сигналом),
+// проверка на горячем пути - пара relaxed чтений
+class Filter {
+   public:
+    static constexpr auto DEFAULT_SLOW_REQUEST = std::chrono::milliseconds(500);
+
+    static Filter& Instance();
+
+    Filter() { Reset(); }
+
+    bool Enabled(Category category, Level level) const noexcept {
+        return level >= levels_[Index(category)].load(std::memory_order_relaxed);
+    }
+    // true для каждой N-й записи категории. Счетчик свой у каждого потока
+    bool Sample(Category category) const noexcept;
+    // Медленные и ошибочные ответы пишутся всегда, мимо выборки
+    bool IsSlow(std::chrono::milliseconds response_time) const noexcept {
+        return response_time.count() >= slow_request_ms_.load(std::memory_order_relaxed);
+    }
+
+    void SetLevel(Category category, Level level) noexcept { levels_[Index(category)].store(level, std::memory_order_relaxed); }
+    void SetSampling(Category category, uint32_t every) noexcept {
+        sampling_[Index(category)].store(std::max<uint32_t>(every, 1), std::memory_order_relaxed);
+    }
+    void SetSlowRequest(std::chrono::milliseconds threshold) noexcept { slow_request_ms_.store(threshold.count(), std::memory_order_relaxed); }
+
+    // INFO без выборки, как до появления фильтра
+    void Reset() noexcept;
+    // Все категории с TRACE без выборки - для разбора проблем на живом сервере
+    void EnableAll() noexcept;
+
+    // Строки вида "<категория> <уровень> [<1 из N>]" и "slow-request-ms <мс>", '#' - комментарий.
+    // При ошибке бросает std::invalid_argument, текущие настройки не меняются
+    void Apply(std::string_view config) { Apply(config, false); }
+    // То же, но не упомянутые в config настройки возвращаются к Reset() - для перечитывания файла
+    void Replace(std::string_view config) { Apply(config, true); }
+
+   private:
+    void Apply(std::string_view config, bool reset);
+    static constexpr size_t Index(Category category) { return static_cast<size_t>(category); }
+
+    std::array<std::atomic<Level>, static_cast<size_t>(Category::COUNT)> levels_;
+    std::array<std::atomic<uint32_t>, static_cast<size_t>(Category::COUNT)> sampling_;
+    std::atomic<int64_t> slow_request_ms_;
+};
+
+// Поле из "data". Имя должно жить всю программу (строковый литерал), значение копируется
+class Field {
+   public:
+    enum class Type : uint8_t { INT, UINT, DOUBLE, BOOL, STRING };
+
+    template <typename T>
+    Field(const char* name, const T& value) : name_(name) {
+        if constexpr (std::is_same_v<T, bool>) {
+            type_ = Type::BOOL;
+            bool_ = value;
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            type_ = Type::INT;
+            int_ = value;
+        } else if constexpr (std::is_integral_v<T>) {
+            type_ = Type::UINT;
+            uint_ = value;
+        } else if constexpr (std::is_floating_point_v<T>) {
+            type_ = Type::DOUBLE;
+            double_ = value;
+        } else {
+            type_ = Type::STRING;
+            string_ = std::string_view(value);
+        }
+    }
+
+   private:
+    friend class Logger;
+
+    const char* name_;
+    Type type_;
+    union {
+        int64_t int_;
+        uint64_t uint_;
+        double double_;
+        bool bool_;
+    };
+    std::string_view string_;
+};
+
+// Запись в очереди: строки лежат внутри, поэтому запись не трогает кучу
+struct Record {
+    static constexpr size_t MAX_FIELDS = 6;
+    static constexpr size_t TEXT_SIZE = 448;
+
+    struct StoredField {
+        const char* name;
+        Field::Type type;
+        union {
+            int64_t int_value;
+            uint64_t uint_value;
+            double double_value;
+            bool bool_value;
+            struct {
+                uint16_t offset;
+                uint16_t size;
+            } text;
+        };
+    };
+
+    int64_t time_us;
+    // raw - готовая строка журнала в text (записи Boost.Log)
+    bool raw;
+    // Готовая строка длиннее TEXT_SIZE лежит в куче целиком: обрезанная, она не была бы JSON.
+    // Освобождает поток журнала
+    std::string* overflow;
+    uint8_t field_count;
+    uint16_t message_size;
+    uint16_t text_size;
+    std::array<StoredField, MAX_FIELDS> fields;
+    std::array<char, TEXT_SIZE> text;
+};
+
+// Формат строки совпадает с форматом Boost.Log из logger.cpp:
+// {"timestamp":"...","data":{...},"message":"..."}
+void AppendJson(std::string& out, const Record& record);
+
+class Logger {
+   public:
+    static constexpr size_t QUEUE_SIZE = 4096;
+    // Сколько раз писатель уступает процессор потоку журнала, прежде чем выбросить запись
+    static constexpr int BACKPRESSURE_SPINS = 64;
+
+    using Sink = std::function<void(std::string_view)>;
+
+    Logger() = default;
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+    ~Logger();
+
+    // Общий журнал сервера, пишет в stdout после InitBoostLogFilter
+    static Logger& Instance();
+
+    void Start(Sink sink);
+    // Дописывает все, что успели положить в очередь, и останавливает поток
+    void Stop();
+
+    void Log(std::string_view message, std::initializer_list<Field> fields = {});
+    // С учетом уровня категории в Filter
+    void Log(Category category, Level level, std::string_view message, std::initializer_list<Field> fields = {}) {
+        if (Filter::Instance().Enabled(category, level))
+            Log(message, fields);
+    }
+    void LogRaw(std::string_view line);
+
+    uint64_t Dropped() const noexcept { return dropped_total_.load(std::memory_order_relaxed); }
+    uint64_t Written() const noexcept { return written_.load(std::memory_order_relaxed); }
+
+   private:
+    template <typename Fill>
+    void Push(Fill&& fill);
+    void Run();
+    size_t Drain(std::string& out);
+
+    MpscRing<Record, QUEUE_SIZE> queue_;
+    Sink sink_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::atomic<bool> sleeping_ = false;
+    std::atomic<bool> stopping_ = false;
+    // Выброшенные с последнего отчета и за все время
+    std::atomic<uint64_t> dropped_ = 0;
+    std::atomic<uint64_t> dropped_total_ = 0;
+    std::atomic<uint64_t> written_ = 0;
+};
+
+inline void Log(std::string_view message, std::initializer_list<Field> fields = {}) { Logger::Instance().Log(message, fields); }
+inline void Log(Category category, Level level, std::string_view message, std::initializer_list<Field> fields = {}) {
+    Logger::Instance().Log(category, level, message, fields);
+}
+
+}  // namespace async_logger
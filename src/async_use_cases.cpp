@@ -0,0 +1,100 @@
+#include "async_use_cases.h"
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <memory>
+#include <optional>
+
+#include "async_logger.h"
+
+namespace app {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Состояние одного запроса. done и timer меняются только на executor вызывающего
+struct Call {
+    Call(net::any_io_executor reply_executor, AsyncUseCases::PlayersHandler players_handler)
+        : reply(std::move(reply_executor)), handler(std::move(players_handler)) {}
+
+    void Finish(AsyncUseCases::Status status, UseCases::players_list_t players) {
+        if (done) 
+            return;
+        done = true;
+        if (timer) 
+            timer->cancel();
+        handler(status, std::move(players));
+    }
+
+    net::any_io_executor reply;
+    AsyncUseCases::PlayersHandler handler;
+    std::optional<net::steady_timer> timer;
+    std::optional<Clock::time_point> deadline;
+    bool done = false;
+};
+
+}  // namespace
+
+void AsyncUseCases::AddPlayerRetired(RetiredPlayerInfo player) {
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    net::post(db_executor_, [this, player = std::move(player)] {
+        // Исключение в пуле БД остановило бы его поток, поэтому только пишем в журнал
+        try {
+            use_cases_.AddPlayerRetired(player);
+        } catch (const std::exception& ex) {
+            async_logger::Log("retired player not saved", {{"name", player.name_}, {"exception", std::string_view(ex.what())}});
+        }
+        pending_.fetch_sub(1, std::memory_order_relaxed);
+    });
+}
+
+void AsyncUseCases::GetPlayersRetired(int offset, int limit, net::any_io_executor reply, PlayersHandler handler) {
+    Run([offset, limit](UseCases& use_cases) { return use_cases.GetPlayersRetired(offset, limit); }, std::move(reply), std::move(handler));
+}
+
+void AsyncUseCases::GetPlayersRetiredAfter(RetiredPlayerInfo after, int limit, net::any_io_executor reply, PlayersHandler handler) {
+    Run([after = std::move(after), limit](UseCases& use_cases) { return use_cases.GetPlayersRetiredAfter(after, limit); }, std::move(reply),
+        std::move(handler));
+}
+
+void AsyncUseCases::Run(Query query, net::any_io_executor reply, PlayersHandler handler) {
+    auto call = std::make_shared<Call>(std::move(reply), std::move(handler));
+
+    if (limits_.max_queue && pending_.fetch_add(1, std::memory_order_relaxed) >= limits_.max_queue) {
+        pending_.fetch_sub(1, std::memory_order_relaxed);
+        net::post(call->reply, [call] { call->Finish(Status::OVERLOADED, {}); });
+        return;
+    }
+    if (!limits_.max_queue) 
+        pending_.fetch_add(1, std::memory_order_relaxed);
+
+    if (limits_.timeout.count()) {
+        call->deadline = Clock::now() + limits_.timeout;
+        call->timer.emplace(call->reply, *call->deadline);
+        call->timer->async_wait([call](const boost::system::error_code& ec) {
+            if (!ec) 
+                call->Finish(Status::TIMEOUT, {});
+        });
+    }
+
+    net::post(db_executor_, [this, call, query = std::move(query)] {
+        auto status = Status::OK;
+        UseCases::players_list_t players;
+        // Вызывающий уже получил TIMEOUT, соединение и время БД на запрос не тратим
+        if (call->deadline && Clock::now() >= *call->deadline) {
+            status = Status::TIMEOUT;
+        } else {
+            try {
+                players = query(use_cases_);
+            } catch (const std::exception& ex) {
+                async_logger::Log("database query failed", {{"exception", std::string_view(ex.what())}});
+                status = Status::FAILED;
+            }
+        }
+        pending_.fetch_sub(1, std::memory_order_relaxed);
+        net::post(call->reply, [call, status, players = std::move(players)]() mutable { call->Finish(status, std::move(players)); });
+    });
+}
+
+}  // namespace app
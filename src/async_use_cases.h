@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <boost/asio/any_io_executor.hpp>
+#include <chrono>
+#include <functional>
+
+#include "use_cases.h"
+
+namespace app {
+
+namespace net = boost::asio;
+
+// Запросы к БД в пуле потоков БД. Ожидание соединения и сам запрос не блокируют
+// вызывающий поток, результат приходит обработчику на executor вызывающего
+class AsyncUseCases {
+   public:
+    enum class Status {
+        OK,
+        OVERLOADED,  // очередь запросов к БД заполнена
+        TIMEOUT,     // ответ не получен за Limits::timeout
+        FAILED,      // ошибка БД
+    };
+
+    struct Limits {
+        // Запросы на чтение сверх этого числа отклоняются сразу, 0 - без ограничения
+        size_t max_queue = 64;
+        // Время от вызова до ответа, 0 - без ограничения
+        std::chrono::milliseconds timeout{2000};
+    };
+
+    using PlayersHandler = std::function<void(Status, UseCases::players_list_t)>;
+
+    AsyncUseCases(UseCases& use_cases, net::any_io_executor db_executor, Limits limits)
+        : use_cases_(use_cases), db_executor_(std::move(db_executor)), limits_(limits) {}
+
+    // Запись не отклоняется по длине очереди, ошибка только пишется в журнал
+    void AddPlayerRetired(RetiredPlayerInfo player);
+
+    // reply - strand или однопоточный executor, на нем вызывается handler
+    void GetPlayersRetired(int offset, int limit, net::any_io_executor reply, PlayersHandler handler);
+    void GetPlayersRetiredAfter(RetiredPlayerInfo after, int limit, net::any_io_executor reply, PlayersHandler handler);
+
+    // Запросы в очереди и в работе
+    size_t Pending() const noexcept { return pending_.load(std::memory_order_relaxed); }
+    const Limits& GetLimits() const noexcept { return limits_; }
+
+   private:
+    using Query = std::function<UseCases::players_list_t(UseCases&)>;
+
+    void Run(Query query, net::any_io_executor reply, PlayersHandler handler);
+
+    UseCases& use_cases_;
+    net::any_io_executor db_executor_;
+    Limits limits_;
+    std::atomic<size_t> pending_ = 0;
+};
+
+}  // namespace app
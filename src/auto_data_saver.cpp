@@ -1,6 +1,11 @@
 #include "auto_data_saver.hpp"
 #include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include "async_logger.h"
 #include "logger.h"
+#include "metrics.h"
 
 namespace data_serializer {
 
@@ -10,43 +15,123 @@ using namespace std::literals;
 DataSaver::DataSaver(app::App * app, const std::string & path) : path_(path), app_(app) {}
 
 void DataSaver::Save() {
+    auto start = metrics::Histogram::Clock::now();
+    auto data = snapshot::Encode(MakeSnapshot());
+
     std::ofstream out(path_ + "_temp"s, std::ios_base::binary);
     if(!out.is_open())
         throw std::invalid_argument("path to save data file");
-    boost::archive::polymorphic_text_oarchive oa{out};
-    auto size_sessions = app_->GetGame().GetSessions().size();
-    oa << size_sessions;
-    for(const auto &session : app_->GetGame().GetSessions()) {
-        auto count_dogs = session->GetCountDogs();
-        oa << count_dogs;
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    out.close();
+
+    std::filesystem::rename(path_ + "_temp"s, path_);
+    metrics::SaveDuration().ObserveSince(start);
+}
+
+snapshot::Snapshot DataSaver::MakeSnapshot() const {
+    snapshot::Snapshot result;
+    // Игрок ссылается на собаку по номеру сессии и номеру собаки в ней
+    std::unordered_map<const model::Dog*, std::pair<uint32_t, uint32_t>> dog_index;
+
+    const auto & sessions = app_->GetGame().GetSessions();
+    result.sessions.reserve(sessions.size());
+    for(const auto &session : sessions) {
+        auto & session_record = result.sessions.emplace_back();
+        session_record.map_id = *session->GetMap()->GetId();
+        session_record.default_speed = session->GetDefaultSpeed();
+        session_record.bag_capacity = session->GetBagCapacity();
+        session_record.last_id_object = session->GetLastIdObject();
+        session_record.randomize_start = session->GetIsGameRandomizeStartCoords();
+
+        session_record.dogs.reserve(session->GetDogs().size());
         for(const auto & dog : session->GetDogs()) {
-            DogRepr dog_repr(dog);
-            oa << dog_repr;
-        }
-        auto count_loot = session->GetLootObjects().size();
-        oa << count_loot;
-        for(const auto & loot : session->GetLootObjects()) {
-            LootObjectRepr loot_repr(loot);
-            oa << loot_repr;
+            dog_index[dog.get()] = {static_cast<uint32_t>(result.sessions.size() - 1), static_cast<uint32_t>(session_record.dogs.size())};
+            session_record.dogs.push_back({*dog->GetId(), dog->GetName(), dog->GetPosition().x, dog->GetPosition().y,
+                                           dog->GetSpeed().x, dog->GetSpeed().y, dog->GetMapSpeed(), dog->GetDirectionChar(),
+                                           dog->GetScore(), dog->GetBag().max_count, dog->GetBag().items});
         }
-        GameSessionRepr session_repr(session);
-        oa << session_repr;
+        session_record.loot.reserve(session->GetLootObjects().size());
+        for(const auto & loot : session->GetLootObjects()) 
+            session_record.loot.push_back({loot->GetId(), loot->GetType(), loot->GetPosition().x, loot->GetPosition().y});
     }
 
-    auto players_count = app_->GetPlayers().GetPlayersList().size();
-    oa << players_count;
     for(const auto &[token, player] : app_->GetPlayers().GetPlayersList()) {
-        PlayerRepr player_repr(*token,player);
-        oa << player_repr;
+        auto it = player ? dog_index.find(player->dog_.get()) : dog_index.end();
+        //Игроки без собаки не сохраняются
+        if(it == dog_index.end()) 
+            continue;
+        result.players.push_back({(*token).hi, (*token).lo, it->second.first, it->second.second});
     }
-
-    out.close();
-
-    std::filesystem::rename(path_ + "_temp"s, path_);
+    return result;
 }
 
 void DataSaver::Load() {
     std::ifstream in(path_, std::ios_base::binary);
+    std::string data{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    if(snapshot::IsBinary(data)) {
+        Restore(snapshot::Decode(data));
+        return;
+    }
+    // Сохранение прошлых версий сервера, следующее Save перезапишет его в двоичном формате
+    std::istringstream text(std::move(data));
+    LoadText(text);
+}
+
+void DataSaver::Restore(const snapshot::Snapshot & snapshot) {
+    auto & mutable_game = app_->GetMutableGame();
+    std::vector<std::pair<std::shared_ptr<model::GameSession>, std::vector<std::shared_ptr<model::Dog>>>> sessions;
+    sessions.reserve(snapshot.sessions.size());
+
+    for(const auto & session_record : snapshot.sessions) {
+        std::vector<std::shared_ptr<model::Dog>> dogs;
+        dogs.reserve(session_record.dogs.size());
+        for(const auto & record : session_record.dogs) {
+            auto dog = std::make_shared<model::Dog>();
+            dog->SetId(model::Dog::Id(record.id));
+            dog->SetName(record.name);
+            dog->SetPosition({record.x, record.y});
+            dog->SetScore(record.score);
+            dog->SetSpeed({record.speed_x, record.speed_y});
+            dog->SetMapSpeed(record.map_speed);
+            dog->SetDirection(static_cast<model::Direction>(record.direction));
+            dog->SetBag(model::Bag{record.bag, record.bag_capacity});
+            dogs.push_back(std::move(dog));
+        }
+
+        std::vector<std::shared_ptr<model::LootObject>> loot_list;
+        loot_list.reserve(session_record.loot.size());
+        for(const auto & record : session_record.loot) {
+            auto loot = std::make_shared<model::LootObject>();
+            loot->SetId(record.id);
+            loot->SetType(record.type);
+            loot->SetPosition({record.x, record.y});
+            loot_list.push_back(std::move(loot));
+        }
+
+        auto session = std::make_shared<model::GameSession>(mutable_game.GetMutableTimeManager(), mutable_game.GetMutableLootGenerator());
+        for(const auto & dog : dogs) 
+            session->AddDog(dog);
+        session->SetLootObjects(loot_list);
+        session->SetDefaultSpeed(session_record.default_speed);
+        session->SetLastIdObject(session_record.last_id_object);
+        session->SetGameRandomizeStartCoords(session_record.randomize_start);
+        session->SetBagCapacity(session_record.bag_capacity);
+        session->setMap(app_->GetGame().FindMap(model::Map::Id(session_record.map_id)));
+        mutable_game.AddSession(session);
+
+        sessions.emplace_back(std::move(session), std::move(dogs));
+    }
+
+    app::Players::Players_t players;
+    for(const auto & record : snapshot.players) {
+        const auto & [session, dogs] = sessions[record.session];
+        players.Insert(util::Token(util::TokenBits{record.token_hi, record.token_lo}),
+                       std::shared_ptr<app::Player>(new app::Player{session, dogs[record.dog]}));
+    }
+    app_->GetMutablePlayers().SetPlayersList(players);
+}
+
+void DataSaver::LoadText(std::istream & in) {
     boost::archive::polymorphic_text_iarchive ia{in};
 
     int size_sessions;
@@ -108,7 +193,14 @@ void DataSaver::Load() {
         PlayerRepr player_repr;
         ia >> player_repr;
         auto [token, player] = player_repr.GetPlayersMap(sessions_all, dogs_all);
-        players[util::Token(token)] = player;
+        auto parsed_token = util::ParseTokenHex(token);
+        if (!parsed_token) {
+            // Сам токен в журнал не пишется
+            async_logger::Log(async_logger::Category::SERVER, async_logger::Level::WARNING, "saved player dropped: invalid token"sv,
+                              {{"token_size", token.size()}, {"dog_id", player && player->dog_ ? *player->dog_->GetId() : size_t{0}}});
+            continue;
+        }
+        players.Insert(*parsed_token, player);
     }
     app_->GetMutablePlayers().SetPlayersList(players);
 }
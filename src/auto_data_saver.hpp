@@ -6,6 +6,7 @@
 #include <boost/archive/polymorphic_text_oarchive.hpp>
 #include <boost/serialization/serialization.hpp>
 #include <boost/serialization/vector.hpp>
+#include "snapshot.h"
 
 namespace model {
 template<class Archive>
@@ -224,11 +225,17 @@ class DataSaver {
     public:
         explicit DataSaver(app::App * app, const std::string & path);
 
+        // Сохраняет в двоичном формате snapshot
         void Save();
+        // Читает и двоичный формат, и старый текстовый
         void Load();
         bool IsSaveExist();
 
     private:
+        snapshot::Snapshot MakeSnapshot() const;
+        void Restore(const snapshot::Snapshot & snapshot);
+        void LoadText(std::istream & in);
+
         std::string path_;
         app::App * app_;
 };
@@ -1,6 +1,7 @@
 #include "common.h"
 
 #include <boost/system.hpp>
+#include <charconv>
 #include <map>
 
 #include "error_codes.h"
@@ -146,46 +147,75 @@ std::string ExecuteAuthorized(HttpResource& res) noexcept(false) {
     return std::string(token_raw.data(), token_raw.size());
 }
 
-std::string_view ExtractArg(Args_t& args) {
-    if (args.empty()) 
-        return ""sv;
-    auto arg = args.front();
-    args.pop_front();
-    return arg;
+std::optional<std::string_view> GetQueryParam(std::string_view query, std::string_view key) {
+    size_t pos = 0;
+    while (pos <= query.size()) {
+        size_t end = query.find('&', pos);
+        if (end == std::string_view::npos)
+            end = query.size();
+        auto property = query.substr(pos, end - pos);
+        auto equal_pos = property.find('=');
+        if (equal_pos != std::string_view::npos && property.substr(0, equal_pos) == key)
+            return property.substr(equal_pos + 1);
+        pos = end + 1;
+    }
+    return std::nullopt;
 }
 
-std::map<std::string, std::string> GetPropertiesFromUrl(const std::string& url) {
-    std::map<std::string, std::string> properties;
-
-    std::size_t pos = url.find('?');
-    if (pos != std::string::npos) {
+int GetQueryParamInt(std::string_view query, std::string_view key, int default_value) {
+    auto value = GetQueryParam(query, key);
+    if (!value)
+        return default_value;
+    int result = 0;
+    std::from_chars(value->data(), value->data() + value->size(), result);
+    return result;
+}
 
-        std::string queryString = url.substr(pos + 1);
+namespace {
 
-        std::size_t startPos = 0;
-        std::size_t endPos;
-        while ((endPos = queryString.find('&', startPos)) != std::string::npos) {
+std::string_view TrimSpaces(std::string_view sv) {
+    while (!sv.empty() && (sv.front() == ' ' || sv.front() == '\t'))
+        sv.remove_prefix(1);
+    while (!sv.empty() && (sv.back() == ' ' || sv.back() == '\t'))
+        sv.remove_suffix(1);
+    return sv;
+}
 
-            std::string property = queryString.substr(startPos, endPos - startPos);
-            std::size_t equalPos = property.find('=');
-            if (equalPos != std::string::npos) {
-                std::string key = property.substr(0, equalPos);
-                std::string value = property.substr(equalPos + 1);
-                properties[key] = value;
-            }
-            startPos = endPos + 1;
-        }
+// "1", "1.0", "0.5", "0.123" -> тысячные. Больше трех знаков после точки RFC 9110 не допускает
+int ParseQValue(std::string_view value) {
+    if (value.empty() || value[0] != '0')
+        return !value.empty() && value[0] == '1' ? 1000 : 0;
+    int quality = 0, scale = 100;
+    for (size_t i = 2; i < value.size() && i < 5 && value[i] >= '0' && value[i] <= '9'; ++i, scale /= 10)
+        quality += (value[i] - '0') * scale;
+    return quality;
+}
 
-        std::string lastProperty = queryString.substr(startPos);
-        std::size_t equalPos = lastProperty.find('=');
-        if (equalPos != std::string::npos) {
-            std::string key = lastProperty.substr(0, equalPos);
-            std::string value = lastProperty.substr(equalPos + 1);
-            properties[key] = value;
+}  // namespace
+
+std::optional<QualityValue> NextQualityValue(std::string_view& header) {
+    if (header.empty())
+        return std::nullopt;
+    auto comma = header.find(',');
+    auto item = header.substr(0, comma);
+    header = comma == std::string_view::npos ? std::string_view{} : header.substr(comma + 1);
+
+    auto semicolon = item.find(';');
+    QualityValue result{TrimSpaces(item.substr(0, semicolon)), 1000};
+    auto params = semicolon == std::string_view::npos ? std::string_view{} : item.substr(semicolon + 1);
+    // q ищется только как целый параметр: "; level=1; q=0" или "; Q = 0.5"
+    while (!params.empty()) {
+        auto next = params.find(';');
+        auto param = params.substr(0, next);
+        params = next == std::string_view::npos ? std::string_view{} : params.substr(next + 1);
+        auto equal = param.find('=');
+        auto name = TrimSpaces(param.substr(0, equal));
+        if (equal != std::string_view::npos && (name == "q" || name == "Q")) {
+            result.quality = ParseQValue(TrimSpaces(param.substr(equal + 1)));
+            break;
         }
     }
-
-    return properties;
+    return result;
 }
 
 }  // namespace util
@@ -1,9 +1,9 @@
 #pragma once
 
 #include <filesystem>
+#include <optional>
 #include <string_view>
 #include <variant>
-#include <map>
 
 #include "headers.h"
 
@@ -35,8 +35,16 @@ void ReadFileToBuffer(message_pack_t& response, std::string_view path_sv, std::s
 
 std::string ExecuteAuthorized(HttpResource& req) noexcept(false);
 
-std::string_view ExtractArg(Args_t & arg);
-
-std::map<std::string, std::string> GetPropertiesFromUrl(const std::string& url);
+// Поиск значения в строке запроса "a=1&b=2" без копирования, значение не декодируется
+std::optional<std::string_view> GetQueryParam(std::string_view query, std::string_view key);
+int GetQueryParamInt(std::string_view query, std::string_view key, int default_value);
+
+// Элемент списка Accept или Accept-Encoding: "gzip;q=0.5" -> {"gzip", 500}. Без q - 1000, q=0 - запрещено
+struct QualityValue {
+    std::string_view value;
+    int quality;
+};
+// Отрезает от header очередной элемент списка. nullopt - список кончился
+std::optional<QualityValue> NextQualityValue(std::string_view& header);
 
 }  // namespace util
\ No newline at end of file
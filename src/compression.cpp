@@ -0,0 +1,149 @@
+#include "compression.h"
+
+#include <boost/beast/zlib/deflate_stream.hpp>
+#include <boost/crc.hpp>
+#include <cctype>
+
+#include "common.h"
+
+namespace {
+namespace http = boost::beast::http;
+namespace zlib = boost::beast::zlib;
+
+bool EqualsIgnoreCase(std::string_view lhs, std::string_view rhs) {
+    if (lhs.size() != rhs.size())
+        return false;
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(lhs[i])) != std::tolower(static_cast<unsigned char>(rhs[i])))
+            return false;
+    }
+    return true;
+}
+
+uint32_t Adler32(std::string_view data) {
+    constexpr uint32_t MOD = 65521;
+    uint32_t a = 1, b = 0;
+    for (unsigned char c : data) {
+        a = (a + c) % MOD;
+        b = (b + a) % MOD;
+    }
+    return (b << 16) | a;
+}
+
+void AppendLE32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i, value >>= 8)
+        out.push_back(static_cast<char>(value & 0xff));
+}
+
+void AppendBE32(std::string& out, uint32_t value) {
+    for (int i = 3; i >= 0; --i)
+        out.push_back(static_cast<char>((value >> (i * 8)) & 0xff));
+}
+
+// Сырой поток deflate (RFC 1951)
+void AppendRawDeflate(std::string& out, std::string_view data, int level) {
+    zlib::deflate_stream stream;
+    stream.reset(level, 15, 8, zlib::Strategy::normal);
+
+    auto header_size = out.size();
+    out.resize(header_size + stream.upper_bound(data.size()));
+
+    zlib::z_params params;
+    params.next_in = data.data();
+    params.avail_in = data.size();
+    params.next_out = out.data() + header_size;
+    params.avail_out = out.size() - header_size;
+
+    boost::beast::error_code ec;
+    stream.write(params, zlib::Flush::finish, ec);
+    if (ec && ec != zlib::error::end_of_stream)
+        throw std::runtime_error("deflate failed: " + ec.message());
+    out.resize(out.size() - params.avail_out);
+}
+
+}  // namespace
+
+namespace compression {
+
+Encoding NegotiateEncoding(std::string_view accept_encoding) {
+    // Явно названная кодировка важнее "*", где бы он ни стоял: gzip;q=0 запрещает gzip
+    int gzip_quality = 0, deflate_quality = 0, any_quality = 0;
+    bool gzip_listed = false, deflate_listed = false;
+    while (auto item = util::NextQualityValue(accept_encoding)) {
+        auto [name, quality] = *item;
+        if (EqualsIgnoreCase(name, "gzip"sv) || EqualsIgnoreCase(name, "x-gzip"sv)) {
+            gzip_quality = quality;
+            gzip_listed = true;
+        } else if (EqualsIgnoreCase(name, "deflate"sv)) {
+            deflate_quality = quality;
+            deflate_listed = true;
+        } else if (name == "*"sv)
+            any_quality = quality;
+    }
+    if (!gzip_listed)
+        gzip_quality = any_quality;
+    if (!deflate_listed)
+        deflate_quality = any_quality;
+    if (gzip_quality > 0 && gzip_quality >= deflate_quality)
+        return Encoding::GZIP;
+    if (deflate_quality > 0)
+        return Encoding::DEFLATE;
+    return Encoding::IDENTITY;
+}
+
+std::string_view GetEncodingName(Encoding encoding) {
+    switch (encoding) {
+        case Encoding::GZIP:
+            return "gzip"sv;
+        case Encoding::DEFLATE:
+            return "deflate"sv;
+        default:
+            return "identity"sv;
+    }
+}
+
+bool IsCompressibleContentType(std::string_view content_type) {
+    return content_type.starts_with("text/"sv) || content_type.starts_with(ContentType::JSON) ||
+           content_type.starts_with("application/xml"sv) || content_type.starts_with("image/svg+xml"sv);
+}
+
+std::string Compress(std::string_view data, Encoding encoding, int level) {
+    std::string out;
+    if (encoding == Encoding::GZIP) {
+        // ID1 ID2 CM=8 FLG=0 MTIME=0 XFL=0 OS=255
+        static constexpr char header[] = {'\x1f', '\x8b', '\x08', 0, 0, 0, 0, 0, 0, '\xff'};
+        out.assign(header, sizeof(header));
+        AppendRawDeflate(out, data, level);
+
+        boost::crc_32_type crc;
+        crc.process_bytes(data.data(), data.size());
+        AppendLE32(out, crc.checksum());
+        AppendLE32(out, static_cast<uint32_t>(data.size()));
+    } else if (encoding == Encoding::DEFLATE) {
+        // CMF=0x78 (32K окно), FLG подобран так, чтобы (CMF*256 + FLG) % 31 == 0
+        out = "\x78\x9c"s;
+        AppendRawDeflate(out, data, level);
+        AppendBE32(out, Adler32(data));
+    } else {
+        out.assign(data.data(), data.size());
+    }
+    return out;
+}
+
+void CompressResponse(StringResponse& resp, Encoding encoding) {
+    if (encoding == Encoding::IDENTITY || resp.body().size() < MIN_DYNAMIC_SIZE || resp.count(http::field::content_encoding))
+        return;
+    if (!IsCompressibleContentType(util::ToSV(resp[http::field::content_type])))
+        return;
+
+    auto compressed = Compress(resp.body(), encoding, DYNAMIC_LEVEL);
+    if (compressed.size() >= resp.body().size())
+        return;
+
+    resp.set(http::field::content_encoding, util::ToBSV(GetEncodingName(encoding)));
+    resp.set(http::field::vary, resp.count(http::field::vary) ? std::string(resp[http::field::vary]) + ", Accept-Encoding"s : "Accept-Encoding"s);
+    resp.content_length(compressed.size());
+    resp.body() = std::move(compressed);
+}
+
+}  // namespace compression
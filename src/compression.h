@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "headers.h"
+
+////////////////////////////////////////////////////////
+//// Сжатие ответов (gzip/deflate) по Accept-Encoding
+////////////////////////////////////////////////////////
+
+namespace compression {
+
+enum class Encoding { IDENTITY, GZIP, DEFLATE };
+
+// Динамические ответы меньше порога не сжимаются, заголовки дороже выигрыша
+constexpr size_t MIN_DYNAMIC_SIZE = 1024;
+// Быстрый уровень для ответов API, максимальный для статики (сжимается один раз)
+constexpr int DYNAMIC_LEVEL = 1;
+constexpr int STATIC_LEVEL = 9;
+
+// Выбор кодировки с учетом q-значений, gzip предпочтительнее deflate
+Encoding NegotiateEncoding(std::string_view accept_encoding);
+std::string_view GetEncodingName(Encoding encoding);
+
+bool IsCompressibleContentType(std::string_view content_type);
+
+// gzip - RFC 1952, deflate - zlib-обертка RFC 1950, как ожидают браузеры
+std::string Compress(std::string_view data, Encoding encoding, int level);
+
+// Сжимает тело готового ответа, если это имеет смысл. Выставляет Content-Encoding и Vary
+void CompressResponse(StringResponse& resp, Encoding encoding);
+
+}  // namespace compression
@@ -1 +1,143 @@
-#include "connection_pool.h"
\ No newline at end of file
+#include "connection_pool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <future>
+#include <pqxx/nontransaction>
+
+namespace postgres {
+
+using pqxx::operator"" _zv;
+
+ConnectionPool::ConnectionPool(const Limits& limits, ConnectionFactory connection_factory, PrepareHook prepare)
+    : limits_(limits)
+    , factory_(std::move(connection_factory))
+    , prepare_(std::move(prepare)) {
+    limits_.max = std::max<size_t>(1, limits_.max);
+    limits_.min = std::min(limits_.min, limits_.max);
+
+    // Установка соединения (TLS, аутентификация) - в основном ожидание сети, поэтому параллельно
+    std::vector<std::future<ConnectionPtr>> opening;
+    opening.reserve(limits_.min);
+    for (size_t i = 0; i < limits_.min; ++i) {
+        opening.push_back(std::async(std::launch::async, [this] { return Connect(); }));
+    }
+    idle_.reserve(limits_.max);
+    for (auto& conn : opening) {
+        idle_.push_back({conn.get(), Clock::now()});
+        ++open_;
+    }
+    metrics::DbPoolOpen().Set(static_cast<int64_t>(open_));
+}
+
+ConnectionPool::ConnectionPtr ConnectionPool::Connect() const {
+    auto conn = factory_();
+    if (prepare_) {
+        prepare_(*conn);
+    }
+    return conn;
+}
+
+bool ConnectionPool::IsAlive(pqxx::connection& conn, Clock::time_point idle_since) const {
+    if (!conn.is_open()) {
+        return false;
+    }
+    if (Clock::now() - idle_since < limits_.idle_check) {
+        return true;
+    }
+    // Сервер или сеть могли закрыть соединение, пока оно простаивало
+    try {
+        pqxx::nontransaction ping{conn};
+        ping.exec("SELECT 1"_zv);
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+ConnectionPool::ConnectionWrapper ConnectionPool::GetConnection() {
+    auto start = metrics::Histogram::Clock::now();
+    std::unique_lock lock{mutex_};
+    // Блокируем текущий поток и ждём, пока освободится соединение или можно будет открыть новое
+    cond_var_.wait(lock, [this] {
+        return !idle_.empty() || open_ < limits_.max;
+    });
+    // После выхода из цикла ожидания мьютекс остаётся захваченным
+    metrics::DbPoolWait().ObserveSince(start);
+
+    ++checked_out_;
+    metrics::DbPoolCheckedOut().Set(static_cast<int64_t>(checked_out_));
+    ConnectionPtr conn;
+    Clock::time_point idle_since;
+    if (!idle_.empty()) {
+        conn = std::move(idle_.back().conn);
+        idle_since = idle_.back().since;
+        idle_.pop_back();
+    } else {
+        ++open_;
+        metrics::DbPoolOpen().Set(static_cast<int64_t>(open_));
+    }
+    lock.unlock();
+
+    // Проверка и открытие соединения идут без блокировки, остальные потоки не ждут сеть
+    try {
+        if (conn && !IsAlive(*conn, idle_since)) {
+            conn.reset();
+            {
+                std::lock_guard guard{mutex_};
+                ++reconnects_;
+            }
+            metrics::DbReconnects().Inc();
+        }
+        if (!conn) {
+            conn = Connect();
+        }
+    } catch (...) {
+        {
+            std::lock_guard guard{mutex_};
+            --checked_out_;
+            metrics::DbPoolCheckedOut().Set(static_cast<int64_t>(checked_out_));
+        }
+        Discard();
+        throw;
+    }
+    return {std::move(conn), *this};
+}
+
+void ConnectionPool::ReturnConnection(ConnectionPtr&& conn) {
+    bool alive = conn->is_open();
+    // Возвращаем соединение обратно в пул
+    {
+        std::lock_guard lock{mutex_};
+        assert(checked_out_ != 0);
+        --checked_out_;
+        metrics::DbPoolCheckedOut().Set(static_cast<int64_t>(checked_out_));
+        if (alive) {
+            idle_.push_back({std::move(conn), Clock::now()});
+        }
+    }
+    if (alive) {
+        // Уведомляем один из ожидающих потоков об изменении состояния пула
+        cond_var_.notify_one();
+        return;
+    }
+    // Соединение разорвано во время работы, на его место при нужде откроется новое
+    Discard();
+}
+
+void ConnectionPool::Discard() {
+    {
+        std::lock_guard lock{mutex_};
+        assert(open_ != 0);
+        --open_;
+        metrics::DbPoolOpen().Set(static_cast<int64_t>(open_));
+    }
+    cond_var_.notify_one();
+}
+
+ConnectionPool::Stats ConnectionPool::GetStats() const {
+    std::lock_guard lock{mutex_};
+    return {open_, checked_out_, reconnects_};
+}
+
+}
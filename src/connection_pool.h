@@ -2,17 +2,41 @@
 
 #include <pqxx/connection>
 #include <pqxx/transaction>
+#include <chrono>
 #include <memory>
 #include <mutex>
 #include <condition_variable>
+#include <functional>
+#include <vector>
+
+#include "metrics.h"
 
 namespace postgres {
 
 class ConnectionPool {
     using PoolType = ConnectionPool;
     using ConnectionPtr = std::shared_ptr<pqxx::connection>;
+    using Clock = std::chrono::steady_clock;
 
 public:
+    using ConnectionFactory = std::function<ConnectionPtr()>;
+    // Вызывается для каждого нового соединения, например чтобы подготовить запросы
+    using PrepareHook = std::function<void(pqxx::connection&)>;
+
+    struct Limits {
+        // Открываются параллельно при создании пула, остальные - по мере нужды до max
+        size_t min = 1;
+        size_t max = 1;
+        // Соединение, простоявшее дольше, проверяется запросом перед выдачей
+        std::chrono::seconds idle_check{30};
+    };
+
+    struct Stats {
+        size_t open = 0;
+        size_t checked_out = 0;
+        uint64_t reconnects = 0;
+    };
+
     class ConnectionWrapper {
     public:
         ConnectionWrapper(std::shared_ptr<pqxx::connection>&& conn, PoolType& pool) noexcept
@@ -46,43 +70,38 @@ public:
         PoolType* pool_;
     };
 
-    // ConnectionFactory is a functional object returning std::shared_ptr<pqxx::connection>
-    template <typename ConnectionFactory>
-    ConnectionPool(size_t capacity, ConnectionFactory&& connection_factory) {
-        pool_.reserve(capacity);
-        for (size_t i = 0; i < capacity; ++i) {
-            pool_.emplace_back(connection_factory());
-        }
-    }
+    // connection_factory вызывается из разных потоков одновременно
+    ConnectionPool(const Limits& limits, ConnectionFactory connection_factory, PrepareHook prepare = {});
 
-    ConnectionWrapper GetConnection() {
-        std::unique_lock lock{mutex_};
-        // Блокируем текущий поток и ждём, пока cond_var_ не получит уведомление и не освободится
-        // хотя бы одно соединение
-        cond_var_.wait(lock, [this] {
-            return used_connections_ < pool_.size();
-        });
-        // После выхода из цикла ожидания мьютекс остаётся захваченным
+    // Ждет свободное соединение. Если все заняты, а открыто меньше max, открывает новое.
+    // Разорванное соединение заменяется новым незаметно для вызывающего
+    ConnectionWrapper GetConnection();
 
-        return {std::move(pool_[used_connections_++]), *this};
-    }
+    Stats GetStats() const;
 
 private:
-    void ReturnConnection(ConnectionPtr&& conn) {
-        // Возвращаем соединение обратно в пул
-        {
-            std::lock_guard lock{mutex_};
-            assert(used_connections_ != 0);
-            pool_[--used_connections_] = std::move(conn);
-        }
-        // Уведомляем один из ожидающих потоков об изменении состояния пула
-        cond_var_.notify_one();
-    }
+    struct Idle {
+        ConnectionPtr conn;
+        Clock::time_point since;
+    };
+
+    ConnectionPtr Connect() const;
+    bool IsAlive(pqxx::connection& conn, Clock::time_point idle_since) const;
+    void ReturnConnection(ConnectionPtr&& conn);
+    // Освобождает место закрытого или не открывшегося соединения
+    void Discard();
+
+    Limits limits_;
+    ConnectionFactory factory_;
+    PrepareHook prepare_;
 
-    std::mutex mutex_;
+    mutable std::mutex mutex_;
     std::condition_variable cond_var_;
-    std::vector<ConnectionPtr> pool_;
-    size_t used_connections_ = 0;
+    std::vector<Idle> idle_;
+    // Открытые и открывающиеся соединения, в том числе выданные
+    size_t open_ = 0;
+    size_t checked_out_ = 0;
+    uint64_t reconnects_ = 0;
 };
 
-}
\ No newline at end of file
+}
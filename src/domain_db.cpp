@@ -1,11 +1,5 @@
 #include "domain_db.h"
 
-#include <boost/uuid/uuid_io.hpp>
-#include <boost/uuid/random_generator.hpp>
-#include <boost/lexical_cast.hpp>
+#include "token_minter.h"
 
-std::string domain::RetiredPlayer::GenerateUuid() { 
-    auto uuid_impl = boost::uuids::random_generator()();
-    auto uuid = boost::lexical_cast<std::string>(uuid_impl);
-    return uuid;
-}
+std::string domain::RetiredPlayer::GenerateUuid() { return util::GenerateRandomUuid(); }
@@ -45,6 +45,8 @@ public:
     using retired_players_t = std::vector<RetiredPlayer>; 
 
     virtual retired_players_t GetSortedRetiredPlayersList(int offset, int limit) = 0;
+    // Записи строго после (score, play_time_ms, name, id) в порядке таблицы рекордов
+    virtual retired_players_t GetSortedRetiredPlayersAfter(int score, int play_time_ms, const std::string & name, const std::string & id, int limit) = 0;
     virtual void AddRetriedPlayer(const RetiredPlayer &) = 0;
 
 protected:
@@ -16,6 +16,20 @@ ErrorCode& operator|=(ErrorCode& lhs, const ErrorCode& rhs) {
     return lhs;
 }
 
+ErrorCode MakeAllowError(uint64_t allowed_verbs) {
+    static const std::pair<http::verb, ErrorCode> verb_flags[] = {
+        {http::verb::get, GET_ALLOWED},         {http::verb::post, POST_NOT_ALLOWED}, {http::verb::put, PUT_ALLOWED},
+        {http::verb::options, OPTIONS_ALLOWED}, {http::verb::head, HEAD_ALLOWED},     {http::verb::delete_, DELETE_ALLOWED},
+        {http::verb::patch, PATCH_ALLOWED}};
+
+    ErrorCode error = NOT_ALLOWED;
+    for (const auto& [verb, flag] : verb_flags) {
+        if (allowed_verbs & router::VerbBit(verb))
+            error |= flag;
+    }
+    return error;
+}
+
 // TODO придумать более обощенную обработку ошибок
 void FillInfoError(StringResponse& resp, ErrorCode ec_code, std::optional<std::string_view> custom_body) {
     std::string_view code = "";
@@ -121,6 +135,12 @@ void FillInfoError(StringResponse& resp, ErrorCode ec_code, std::optional<std::s
             code = "unknownToken"sv;
             message = "Player token has not been found"sv;
             break;
+        case ErrorCode::SERVICE_UNAVAILABLE:
+            // Retry-After выставляет тот, кто отказал в обслуживании
+            resp.result(http::status::service_unavailable);
+            code = "serviceUnavailable"sv;
+            message = "Server is overloaded, retry later"sv;
+            break;
         case ErrorCode::FILE_NOT_EXIST:
             resp.result(http::status::not_found);
             resp.set(http::field::content_type, "text/plain");
@@ -29,6 +29,7 @@ enum ErrorCode : uint32_t {
     AUTHORIZATION_NOT_FOUND = 0xb,
     BAD_REQUEST_TICK = 0xc,
     BAD_TICK_ACCESS = 0xd,
+    SERVICE_UNAVAILABLE = 0xe,
 
     NOT_ALLOWED = 1 << 8,
     POST_NOT_ALLOWED = 1 << 9,
@@ -42,6 +43,9 @@ enum ErrorCode : uint32_t {
 
 ErrorCode& operator|=(ErrorCode& lhs, const ErrorCode& rhs);
 
+// Нестандартный код ошибки 405, содержит в себе список разрешенных методов (маска router::VerbBit)
+ErrorCode MakeAllowError(uint64_t allowed_verbs);
+
 void FillInfoError(StringResponse& resp, ErrorCode code, std::optional<std::string_view> custom_body = std::nullopt);
 
 }  // namespace http_handler
@@ -0,0 +1,120 @@
+#include "executors.h"
+
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace executors {
+
+bool PinCurrentThread(unsigned cpu) {
+#ifdef __linux__
+    if (cpu >= CPU_SETSIZE) 
+        return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+CpuSet ParseCpuList(std::string_view list) {
+    auto parse_number = [list](std::string_view text) {
+        unsigned value = 0;
+        auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (ec != std::errc() || end != text.data() + text.size() || text.empty()) 
+            throw std::invalid_argument("Invalid cpu list: " + std::string(list));
+        return value;
+    };
+
+    CpuSet cpus;
+    for (size_t pos = 0; pos < list.size();) {
+        auto comma = std::min(list.find(',', pos), list.size());
+        auto item = list.substr(pos, comma - pos);
+        auto dash = item.find('-');
+        unsigned first = parse_number(item.substr(0, dash));
+        unsigned last = dash == std::string_view::npos ? first : parse_number(item.substr(dash + 1));
+        if (last < first) 
+            throw std::invalid_argument("Invalid cpu range: " + std::string(item));
+        for (unsigned cpu = first; cpu <= last; ++cpu) 
+            cpus.push_back(cpu);
+        pos = comma + 1;
+        if (pos == list.size()) 
+            throw std::invalid_argument("Invalid cpu list: " + std::string(list));
+    }
+    return cpus;
+}
+
+bool PinCurrentThread(const CpuSet& cpus) {
+    if (cpus.empty()) 
+        return true;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto cpu : cpus) {
+        if (cpu < CPU_SETSIZE) 
+            CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+ThreadPool::ThreadPool(unsigned threads, CpuSet cpus)
+    : threads_(std::max(1u, threads)), cpus_(std::move(cpus)), context_(static_cast<int>(threads_)) {}
+
+void ThreadPool::Start() {
+    work_.emplace(context_.get_executor());
+    for (unsigned i = 0; i < threads_; ++i) {
+        workers_.emplace_back([this] {
+            PinCurrentThread(cpus_);
+            context_.run();
+        });
+    }
+}
+
+void ThreadPool::Stop() {
+    work_.reset();
+    context_.stop();
+    workers_.clear();
+}
+
+void ThreadPool::Drain() {
+    work_.reset();
+    workers_.clear();
+}
+
+CoreContexts::CoreContexts(unsigned cores, CpuSet cpus) : cpus_(std::move(cpus)) {
+    for (unsigned core = 1; core < cores; ++core) 
+        contexts_.push_back(std::make_unique<net::io_context>(1));
+}
+
+void CoreContexts::Run(net::io_context& main_context) {
+    std::vector<std::jthread> threads;
+    threads.reserve(contexts_.size());
+    for (size_t i = 0; i < contexts_.size(); ++i) {
+        threads.emplace_back([context = contexts_[i].get(), cpu = Cpu(i + 1)] {
+            PinCurrentThread(cpu);
+            context->run();
+        });
+    }
+    PinCurrentThread(Cpu(0));
+    main_context.run();
+    // jthread дожидается остальных ядер
+}
+
+void CoreContexts::Stop() {
+    for (auto& context : contexts_) 
+        context->stop();
+}
+
+}  // namespace executors
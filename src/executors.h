@@ -0,0 +1,76 @@
+#pragma once
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////
+//// Потоки сервера и их привязка к ядрам
+////////////////////////////////////////////////
+
+namespace executors {
+
+namespace net = boost::asio;
+
+using CpuSet = std::vector<unsigned>;
+
+// "0-3,6" -> {0, 1, 2, 3, 6}. При ошибке бросает std::invalid_argument
+CpuSet ParseCpuList(std::string_view list);
+
+// false - привязка не поддерживается или ядра нет, поток продолжает работать где угодно
+bool PinCurrentThread(unsigned cpu);
+// Пустой набор - без привязки
+bool PinCurrentThread(const CpuSet& cpus);
+
+// Отдельный io_context со своими потоками, например для симуляции или запросов к БД,
+// чтобы медленная работа одного пула не задерживала другой
+class ThreadPool {
+   public:
+    ThreadPool(unsigned threads, CpuSet cpus = {});
+    ~ThreadPool() { Stop(); }
+
+    net::io_context& Context() noexcept { return context_; }
+    net::io_context::executor_type GetExecutor() noexcept { return context_.get_executor(); }
+
+    void Start();
+    // Отбросить оставшуюся работу
+    void Stop();
+    // Доделать уже поставленную работу и завершить потоки
+    void Drain();
+
+   private:
+    unsigned threads_;
+    CpuSet cpus_;
+    net::io_context context_;
+    std::optional<net::executor_work_guard<net::io_context::executor_type>> work_;
+    std::vector<std::jthread> workers_;
+};
+
+// Режим "поток на ядро": у каждого ядра свой io_context с одним потоком.
+// Контекст ядра 0 создает вызывающий код, здесь только остальные ядра
+class CoreContexts {
+   public:
+    // cores - всего ядер вместе с ядром 0. cpus - номера ядер для привязки по порядку,
+    // пустой набор - ядра 0..cores-1
+    explicit CoreContexts(unsigned cores, CpuSet cpus = {});
+
+    size_t size() const noexcept { return contexts_.size(); }
+    net::io_context& operator[](size_t index) { return *contexts_[index]; }
+
+    // Запускает по потоку на контекст (ядра 1..N), затем main_context в текущем потоке на ядре 0.
+    // Возвращает управление после остановки main_context и всех контекстов ядер
+    void Run(net::io_context& main_context);
+    void Stop();
+
+   private:
+    unsigned Cpu(size_t core) const noexcept { return cpus_.empty() ? static_cast<unsigned>(core) : cpus_[core % cpus_.size()]; }
+
+    CpuSet cpus_;
+    std::vector<std::unique_ptr<net::io_context>> contexts_;
+};
+
+}  // namespace executors
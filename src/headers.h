@@ -7,15 +7,21 @@
 #include <boost/beast/http.hpp>
 #include <boost/asio.hpp>
 #include <deque>
+#include <functional>
 #include <string_view>
 #include <variant>
 
+#include "http_message.h"
+#include "router.h"
+#include "shared_body.h"
+
 using namespace std::literals;
 
 struct ContentType {
     ContentType() = delete;
     static constexpr auto TEXT_HTML = "text/html"sv;
     static constexpr auto JSON = "application/json"sv;
+    static constexpr auto OCTET_STREAM = "application/octet-stream"sv;
     static constexpr auto ONLY_READ_ALLOW = "GET, HEAD"sv;
     static constexpr auto INDEX_HTML = "/index.html"sv;
     static constexpr auto API_TYPE = "api"sv;
@@ -24,14 +30,34 @@ struct ContentType {
 
 using Args_t = std::deque<std::string_view>;
 
-using StringRequest = boost::beast::http::request<boost::beast::http::string_body>;
+using StringRequest = http_message::StringRequest;
 using StringResponse = boost::beast::http::response<boost::beast::http::string_body>;
 using FileRequest = boost::beast::http::request<boost::beast::http::file_body>;
 using FileResponse = boost::beast::http::response<boost::beast::http::file_body>;
-using message_pack_t = std::variant<FileResponse, StringResponse>;
+using CachedResponse = boost::beast::http::response<SharedBufferBody>;
+using message_pack_t = std::variant<FileResponse, StringResponse, CachedResponse>;
 
 using strand_t = boost::asio::strand<boost::asio::io_context::executor_type>;
 
+// Отложенный ответ (long-poll). Обработчик забирает отправителя через Take,
+// после этого ответ отправляет он сам, а не RequestHandler
+class DeferredSend {
+   public:
+    using sender_t = std::function<void(StringResponse&&)>;
+
+    explicit DeferredSend(sender_t sender) : sender_(std::move(sender)) {}
+
+    sender_t Take() {
+        deferred_ = true;
+        return std::move(sender_);
+    }
+    bool IsDeferred() const { return deferred_; }
+
+   private:
+    sender_t sender_;
+    bool deferred_ = false;
+};
+
 // Совмещает в себе ответ аргументы и запрос, для экономии места
 struct HttpResource {
     HttpResource(HttpResource&&) = default;
@@ -39,11 +65,13 @@ struct HttpResource {
     HttpResource(const HttpResource&) = default;
     HttpResource& operator=(HttpResource&) = default;
 
-    HttpResource(const StringRequest& request, StringResponse& response, Args_t&& arguments)
-        : req(request), resp(response), args(std::move(arguments)) {}
+    HttpResource(const StringRequest& request, StringResponse& response, const router::Params& route_params, DeferredSend& deferred_send)
+        : req(request), resp(response), params(route_params), deferred(deferred_send) {}
     HttpResource() = delete;
 
     const StringRequest& req;
     StringResponse& resp;
-    Args_t args;
+    // Параметры пути из шаблона маршрута и строка запроса
+    router::Params params;
+    DeferredSend& deferred;
 };
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <boost/beast/http/fields.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <memory_resource>
+#include <string>
+#include <type_traits>
+
+// Запрос, поля и тело которого берут память из переданного memory_resource.
+// Без ресурса используется обычная куча, поведение как у http::request<string_body>
+namespace http_message {
+
+// std::pmr::polymorphic_allocator не присваивается, а Beast этого требует от аллокатора полей.
+// Ресурс переезжает вместе с перемещаемым объектом, копия всегда уходит в кучу по умолчанию
+template <typename T>
+class ResourceAllocator {
+   public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    ResourceAllocator() noexcept : resource_(std::pmr::get_default_resource()) {}
+    explicit ResourceAllocator(std::pmr::memory_resource* resource) noexcept : resource_(resource) {}
+    template <typename U>
+    ResourceAllocator(const ResourceAllocator<U>& other) noexcept : resource_(other.resource()) {}
+
+    T* allocate(std::size_t n) { return static_cast<T*>(resource_->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T* ptr, std::size_t n) noexcept { resource_->deallocate(ptr, n * sizeof(T), alignof(T)); }
+
+    ResourceAllocator select_on_container_copy_construction() const noexcept { return ResourceAllocator(); }
+
+    std::pmr::memory_resource* resource() const noexcept { return resource_; }
+
+    template <typename U>
+    bool operator==(const ResourceAllocator<U>& other) const noexcept {
+        return resource_ == other.resource() || resource_->is_equal(*other.resource());
+    }
+
+   private:
+    std::pmr::memory_resource* resource_;
+};
+
+using Allocator = ResourceAllocator<char>;
+using Fields = boost::beast::http::basic_fields<Allocator>;
+using StringBody = boost::beast::http::basic_string_body<char, std::char_traits<char>, Allocator>;
+using StringRequest = boost::beast::http::request<StringBody, Fields>;
+
+inline StringRequest MakeRequest(std::pmr::memory_resource* resource) {
+    return StringRequest{StringRequest::header_type{Allocator(resource)}, StringBody::value_type{Allocator(resource)}};
+}
+
+}  // namespace http_message
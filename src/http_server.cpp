@@ -1,68 +1,390 @@
 #include "http_server.h"
 
 #include <boost/asio/dispatch.hpp>
+#include <cerrno>
 #include <iostream>
+#include <vector>
 
-#include "json_loader.h"
-#include "logger.h"
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+#include "async_logger.h"
+#include "common.h"
+
+namespace {
+using namespace std::literals;
+
+// Токен игрока из ?token= (вход в WebSocket) не должен попадать в журнал
+std::string_view RedactToken(std::string_view target, std::string& buffer) {
+    auto query = target.find('?');
+    if (query == std::string_view::npos || target.find("token="sv, query) == std::string_view::npos) 
+        return target;
+    buffer.assign(target.substr(0, query + 1));
+    auto rest = target.substr(query + 1);
+    while (true) {
+        auto end = rest.find('&');
+        auto param = rest.substr(0, end);
+        buffer += param.starts_with("token="sv) ? "token=***"sv : param;
+        if (end == std::string_view::npos) 
+            break;
+        buffer += '&';
+        rest.remove_prefix(end + 1);
+    }
+    return buffer;
+}
+
+}  // namespace
 
 namespace http_server {
 void ReportError(beast::error_code ec, std::string_view what) {
-    BOOST_LOG_TRIVIAL(info) << "error"
-                            << logging::add_value(additional_data,
-                                                  json_loader::CreateTrivialJson({"code", "text", "where"}, ec.value(), ec.what(), what));
+    if (!async_logger::Filter::Instance().Enabled(async_logger::Category::NETWORK, async_logger::Level::ERROR)) 
+        return;
+    auto text = ec.what();
+    async_logger::Log("error"sv, {{"code", ec.value()}, {"text", text}, {"where", what}});
 }
 void SessionBase::Run() { net::dispatch(stream_.get_executor(), beast::bind_front_handler(&SessionBase::Read, GetSharedThis())); }
 void SessionBase::Read() {
     using namespace std::literals;
-    request_ = {};
-    stream_.expires_after(30s);
+    reading_ = true;
+    request_ = http_message::MakeRequest(&memory_);
+    stream_.expires_after(IO_TIMEOUT);
     http::async_read(stream_, buffer_, request_, beast::bind_front_handler(&SessionBase::OnRead, GetSharedThis()));
 }
+void SessionBase::ReadNext() {
+    // Пока очередь ответов заполнена, новые запросы остаются в буфере и сокете
+    if (!reading_ && !read_closed_ && !pending_upgrade_ && InFlight() < MAX_PIPELINE) 
+        Read();
+}
 void SessionBase::LogRead() {
-    BOOST_LOG_TRIVIAL(info) << "request received"
-                            << logging::add_value(
-                                   additional_data,
-                                   json_loader::CreateTrivialJson({"ip", "URI", "method"}, stream_.socket().remote_endpoint().address().to_string(),
-                                                                  request_.target(), request_.method_string()));
-}
-void SessionBase::LogWrite(int status_code, std::string_view content_type) {
-    BOOST_LOG_TRIVIAL(info)
-        << "response sent"
-        << logging::add_value(
-               additional_data,
-               json_loader::CreateTrivialJson(
-                   {"response_time", "code", "content_type"},
-                   std::chrono::duration_cast<std::chrono::milliseconds>((std::chrono::system_clock::now() - _last_received_time_point)).count(),
-                   status_code, content_type));
+    auto& filter = async_logger::Filter::Instance();
+    if (!filter.Enabled(async_logger::Category::REQUEST, async_logger::Level::INFO) || !filter.Sample(async_logger::Category::REQUEST)) 
+        return;
+    // Адрес клиента за время соединения не меняется, лишний системный вызов на каждый запрос не нужен
+    if (remote_ip_.empty()) {
+        beast::error_code ec;
+        auto endpoint = stream_.socket().remote_endpoint(ec);
+        remote_ip_ = ec ? "unknown"s : endpoint.address().to_string();
+    }
+    std::string redacted;
+    async_logger::Log("request received"sv, {{"ip", remote_ip_},
+                                             {"URI", RedactToken(util::ToSV(request_.target()), redacted)},
+                                             {"method", util::ToSV(request_.method_string())}});
+}
+void SessionBase::LogWrite(uint64_t seq, int status_code, std::string_view content_type) {
+    auto response_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - received_[seq % MAX_PIPELINE]);
+    auto& filter = async_logger::Filter::Instance();
+    // Ошибки сервера и медленные ответы видны всегда, остальное - по выборке
+    auto level = status_code >= 500 || filter.IsSlow(response_time) ? async_logger::Level::WARNING : async_logger::Level::INFO;
+    if (!filter.Enabled(async_logger::Category::RESPONSE, level) || (level == async_logger::Level::INFO && !filter.Sample(async_logger::Category::RESPONSE))) 
+        return;
+    async_logger::Log("response sent"sv, {{"response_time", response_time.count()}, {"code", status_code}, {"content_type", content_type}});
 }
 void SessionBase::OnRead(beast::error_code ec, std::size_t bytes_read) {
     using namespace std::literals;
+    reading_ = false;
 
     if (ec == http::error::end_of_stream) {
-        return Close();
+        read_closed_ = true;
+        // Ответы на уже принятые запросы еще нужно дописать
+        if (InFlight() == 0) 
+            Close();
+        return;
     }
     if (ec) {
+        // Поток чтения мертв: новых запросов не будет, уже принятые еще могут получить ответ
+        read_closed_ = true;
+        pending_upgrade_.reset();
         return ReportError(ec, "read"sv);
     }
 
-    _last_received_time_point = std::chrono::system_clock::now();
+    auto received = std::chrono::steady_clock::now();
     LogRead();
- 
-    HandleRequest(std::move(request_));
+
+    if (websocket::is_upgrade(request_)) {
+        // Сокет можно отдать только после того, как уйдут все ответы
+        if (InFlight() == 0) 
+            return HandleUpgrade(std::move(request_));
+        pending_upgrade_.emplace(std::move(request_));
+        return;
+    }
+    if (!request_.keep_alive()) 
+        read_closed_ = true;
+    auto accept_encoding = request_[http::field::accept_encoding];
+    received_[next_read_seq_ % MAX_PIPELINE] = received;
+    encodings_[next_read_seq_ % MAX_PIPELINE] = compression::NegotiateEncoding(std::string_view(accept_encoding.data(), accept_encoding.size()));
+    auto& request = requests_[next_read_seq_ % MAX_PIPELINE].emplace(std::move(request_));
+    HandleRequest(request, next_read_seq_++);
+    ReadNext();
+}
+tcp::socket SessionBase::ReleaseSocket() {
+    stream_.expires_never();
+    owns_connection_ = false;
+    return stream_.release_socket();
 }
 void SessionBase::Close() {
     try {
         stream_.socket().shutdown(tcp::socket::shutdown_send);
     }catch(...) {}
 }
+void SessionBase::QueueWrite(uint64_t seq, std::shared_ptr<PendingResponse> pending) {
+    // Обработчик ответил и запрос ему больше не нужен: память возвращается в пул здесь, в executor сокета
+    requests_[seq % MAX_PIPELINE].reset();
+    if (write_failed_) 
+        return;
+    pending->Compress(encodings_[seq % MAX_PIPELINE]);
+    ready_[seq % MAX_PIPELINE] = std::move(pending);
+    TryWrite();
+}
+void SessionBase::TryWrite() {
+    auto& next = ready_[next_write_seq_ % MAX_PIPELINE];
+    if (in_flight_ || !next || write_failed_) 
+        return;
+    in_flight_ = std::move(next);
+    in_flight_->Start(*this);
+}
 void SessionBase::OnWrite(bool close, beast::error_code ec, std::size_t bytes_written) {
+    // Ответ освобождается до продолжения работы, пока его память еще принадлежит пулу
+    in_flight_.reset();
+    ++next_write_seq_;
+
     if (ec) {
+        // Остальные ответы уже не дойдут: очередь сбрасывается, чтение прерывается
+        write_failed_ = true;
+        read_closed_ = true;
+        pending_upgrade_.reset();
+        ready_.fill(nullptr);
+        beast::error_code ignored;
+        stream_.socket().close(ignored);
         return ReportError(ec, "write"sv);
     }
     if (close) {
+        read_closed_ = true;
         return Close();
     }
+    if (InFlight() == 0) {
+        if (pending_upgrade_) {
+            auto request = std::move(*pending_upgrade_);
+            pending_upgrade_.reset();
+            return HandleUpgrade(std::move(request));
+        }
+        if (read_closed_ && !reading_) 
+            return Close();
+    }
+    TryWrite();
+    ReadNext();
+}
+
+struct SessionBase::FileTransfer : PendingResponse {
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+    static constexpr std::chrono::seconds SEND_TIMEOUT = IO_TIMEOUT;
+
+    explicit FileTransfer(http::response<http::file_body>&& res) : response(std::move(res)), serializer(response) {
+        size = response.body().size();
+        serializer.split(true);
+    }
+
+    void Start(SessionBase& session) override { session.WriteFileHeader(*this); }
+
+    http::response<http::file_body> response;
+    http::response_serializer<http::file_body> serializer;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    std::vector<char> buffer;
+};
+
+std::shared_ptr<SessionBase::PendingResponse> SessionBase::MakeFileTransfer(http::response<http::file_body>&& response) {
+    return std::make_shared<FileTransfer>(std::move(response));
+}
+
+// Передача живет в in_flight_ до вызова OnWrite, поэтому ссылку можно держать в обработчиках
+void SessionBase::WriteFileHeader(FileTransfer& transfer) {
+    stream_.expires_after(IO_TIMEOUT);
+    http::async_write_header(stream_, transfer.serializer, [&transfer, self = GetSharedThis()](beast::error_code ec, std::size_t bytes_written) {
+        if (ec) 
+            return self->OnWrite(true, ec, bytes_written);
+#ifdef __linux__
+        self->SendFileBody(transfer);
+#else
+        self->CopyFileBody(transfer);
+#endif
+    });
+}
+
+void SessionBase::SendFileBody(FileTransfer& transfer) {
+#ifdef __linux__
+    auto& socket = stream_.socket();
+    if (beast::error_code ec; !socket.native_non_blocking() && (socket.native_non_blocking(true, ec), ec)) 
+        return CopyFileBody(transfer);
+
+    int file_fd = transfer.response.body().file().native_handle();
+    while (transfer.offset < transfer.size) {
+        off_t offset = static_cast<off_t>(transfer.offset);
+        auto sent = ::sendfile(socket.native_handle(), file_fd, &offset, transfer.size - transfer.offset);
+        if (sent > 0) {
+            transfer.offset = static_cast<uint64_t>(offset);
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) 
+            continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) 
+            return WaitWritable(transfer);
+        // Файловая система не поддерживает sendfile - отдаем обычным копированием
+        if (sent < 0 && (errno == EINVAL || errno == ENOSYS) && transfer.offset == 0) 
+            return CopyFileBody(transfer);
+
+        beast::error_code ec = sent == 0 ? beast::error_code(net::error::eof) : beast::error_code(errno, sys::system_category());
+        return OnWrite(true, ec, static_cast<std::size_t>(transfer.offset));
+    }
+    OnWrite(transfer.response.need_eof(), {}, static_cast<std::size_t>(transfer.size));
+#else
+    CopyFileBody(transfer);
+#endif
+}
+
+// Клиент, переставший читать, не должен держать сессию и файл вечно: по таймеру ожидание отменяется
+void SessionBase::WaitWritable(FileTransfer& transfer) {
+    send_timer_.expires_after(FileTransfer::SEND_TIMEOUT);
+    send_timer_.async_wait([self = GetSharedThis()](beast::error_code ec) {
+        // Таймер мог успеть сработать уже после того, как сокет стал доступен для записи
+        if (ec || self->send_timer_.expiry() > net::steady_timer::clock_type::now()) 
+            return;
+        beast::error_code ignored;
+        self->stream_.socket().cancel(ignored);
+    });
+    stream_.socket().async_wait(tcp::socket::wait_write, [&transfer, self = GetSharedThis()](beast::error_code ec) {
+        bool timed_out = self->send_timer_.expiry() <= net::steady_timer::clock_type::now();
+        self->send_timer_.expires_at(net::steady_timer::time_point::max());
+        if (ec) 
+            return self->OnWrite(true, timed_out ? beast::error_code(beast::error::timeout) : ec, static_cast<std::size_t>(transfer.offset));
+        self->SendFileBody(transfer);
+    });
+}
+
+void SessionBase::CopyFileBody(FileTransfer& transfer) {
+    if (transfer.offset == transfer.size) 
+        return OnWrite(transfer.response.need_eof(), {}, static_cast<std::size_t>(transfer.size));
+
+    auto& file = transfer.response.body().file();
+    transfer.buffer.resize(std::min<uint64_t>(FileTransfer::CHUNK_SIZE, transfer.size - transfer.offset));
+
+    beast::error_code ec;
+    file.seek(transfer.offset, ec);
+    auto read = ec ? 0 : file.read(transfer.buffer.data(), transfer.buffer.size(), ec);
+    if (ec || read == 0) 
+        return OnWrite(true, ec ? ec : beast::error_code(net::error::eof), static_cast<std::size_t>(transfer.offset));
+
+    stream_.expires_after(IO_TIMEOUT);
+    net::async_write(stream_, net::buffer(transfer.buffer.data(), read), [&transfer, self = GetSharedThis()](beast::error_code ec, std::size_t bytes_written) {
+        if (ec) 
+            return self->OnWrite(true, ec, bytes_written);
+        transfer.offset += bytes_written;
+        self->CopyFileBody(transfer);
+    });
+}
+
+//////// WEBSOCKET ///////////
+
+void WebSocketSession::Run(HttpRequest&& upgrade_request, MessageHandler on_message, CloseHandler on_close) {
+    on_message_ = std::move(on_message);
+    on_close_ = std::move(on_close);
+    upgrade_request_ = std::move(upgrade_request);
+    net::dispatch(ws_.get_executor(), [self = shared_from_this()] {
+        self->ws_.set_option(websocket::stream_base::timeout::suggested(beast::role_type::server));
+        self->ws_.text(true);
+        self->ws_.async_accept(self->upgrade_request_, beast::bind_front_handler(&WebSocketSession::OnAccept, self));
+    });
+}
+void WebSocketSession::Reject(HttpResponse&& response) {
+    net::dispatch(ws_.get_executor(), [self = shared_from_this(), response = std::move(response)]() mutable {
+        auto safe_response = std::make_shared<HttpResponse>(std::move(response));
+        safe_response->keep_alive(false);
+        safe_response->prepare_payload();
+        http::async_write(self->ws_.next_layer(), *safe_response, [self, safe_response](beast::error_code, std::size_t) {
+            beast::error_code ec;
+            self->ws_.next_layer().socket().shutdown(tcp::socket::shutdown_send, ec);
+        });
+    });
+}
+void WebSocketSession::Send(std::shared_ptr<const std::string> message) {
+    net::post(ws_.get_executor(), [self = shared_from_this(), message = std::move(message)]() mutable {
+        if (self->state_ == State::CLOSED) 
+            return;
+        // Первый элемент может быть уже в процессе записи, его трогать нельзя
+        while (self->queue_.size() >= MAX_QUEUE_SIZE && self->queue_.size() > 1) 
+            self->queue_.erase(self->queue_.begin() + (self->write_in_progress_ ? 1 : 0));
+        self->queue_.push_back(std::move(message));
+        if (self->state_ == State::OPEN && !self->write_in_progress_) 
+            self->DoWrite();
+    });
+}
+void WebSocketSession::Close() {
+    net::post(ws_.get_executor(), [self = shared_from_this()] {
+        // Закрыть посреди рукопожатия нельзя, это сделает OnAccept
+        if (self->state_ == State::HANDSHAKE) 
+            self->close_requested_ = true;
+        else if (self->state_ == State::OPEN) 
+            self->DoClose();
+    });
+}
+void WebSocketSession::DoClose() {
+    state_ = State::CLOSED;
+    DropQueued();
+    ws_.async_close(websocket::close_code::normal, [self = shared_from_this()](beast::error_code) {});
+}
+void WebSocketSession::OnAccept(beast::error_code ec) {
+    if (ec) {
+        ReportError(ec, "websocket accept"sv);
+        return Finish();
+    }
+    if (state_ == State::CLOSED) 
+        return;
+    upgrade_request_ = {};
+    state_ = State::OPEN;
+    // Чтение получит ответный close и завершит сессию через Finish
+    Read();
+    if (close_requested_) 
+        return DoClose();
+    if (!queue_.empty()) 
+        DoWrite();
+}
+void WebSocketSession::Read() { ws_.async_read(buffer_, beast::bind_front_handler(&WebSocketSession::OnRead, shared_from_this())); }
+void WebSocketSession::OnRead(beast::error_code ec, std::size_t bytes_read) {
+    if (ec) {
+        if (ec != websocket::error::closed) 
+            ReportError(ec, "websocket read"sv);
+        return Finish();
+    }
+    if (on_message_) 
+        on_message_(beast::buffers_to_string(buffer_.data()));
+    buffer_.consume(buffer_.size());
     Read();
 }
+void WebSocketSession::DoWrite() {
+    write_in_progress_ = true;
+    ws_.async_write(net::buffer(*queue_.front()), beast::bind_front_handler(&WebSocketSession::OnWrite, shared_from_this()));
+}
+void WebSocketSession::OnWrite(beast::error_code ec, std::size_t bytes_written) {
+    write_in_progress_ = false;
+    // Записанное сообщение освобождается только здесь: до завершения записи Beast читает из него
+    queue_.pop_front();
+    if (ec) {
+        queue_.clear();
+        return ReportError(ec, "websocket write"sv);
+    }
+    if (state_ == State::OPEN && !queue_.empty()) 
+        DoWrite();
+}
+void WebSocketSession::DropQueued() {
+    if (queue_.empty()) 
+        return;
+    queue_.erase(queue_.begin() + (write_in_progress_ ? 1 : 0), queue_.end());
+}
+void WebSocketSession::Finish() {
+    state_ = State::CLOSED;
+    DropQueued();
+    if (auto on_close = std::move(on_close_)) 
+        on_close();
+    on_message_ = {};
+}
 }  // namespace http_server
\ No newline at end of file
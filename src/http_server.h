@@ -3,14 +3,26 @@
 // boost.beast будет использовать std::string_view вместо boost::string_view
 // #define BOOST_BEAST_USE_STD_STRING_VIEW
 
+#include <boost/asio/dispatch.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/asio/strand.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
+#include <boost/beast/websocket.hpp>
+#include <array>
 #include <chrono>
+#include <deque>
+#include <functional>
 #include <iostream>
+#include <memory_resource>
+#include <optional>
+#include <type_traits>
 #include <variant>
 
+#include "admission_control.h"
+#include "compression.h"
+#include "http_message.h"
 // #include "common.h"
 
 namespace http_server {
@@ -20,59 +32,204 @@ namespace beast = boost::beast;
 namespace http = beast::http;
 namespace sys = boost::system;
 namespace net = boost::asio;
+namespace websocket = beast::websocket;
 using tcp = net::ip::tcp;
 using namespace std::literals;
 
 void ReportError(beast::error_code ec, std::string_view what);
 
+// Соединение, переключенное с HTTP на WebSocket (Upgrade).
+// Сервер рассылает по нему состояние игры, клиент присылает команды.
+// Send потокобезопасен: запись всегда выполняется внутри strand сокета
+class WebSocketSession : public std::enable_shared_from_this<WebSocketSession> {
+   public:
+    using HttpRequest = http_message::StringRequest;
+    using HttpResponse = http::response<http::string_body>;
+    using MessageHandler = std::function<void(std::string&&)>;
+    using CloseHandler = std::function<void()>;
+
+    // Состояние целиком заменяет предыдущее, поэтому медленному клиенту
+    // незачем копить очередь: старые снапшоты выбрасываются
+    static constexpr size_t MAX_QUEUE_SIZE = 4;
+
+    // Вместе с сокетом забирает у HTTP сессии место в --max-connections, освобождает его при разрушении
+    explicit WebSocketSession(tcp::socket&& socket) : ws_(std::move(socket)) {}
+    ~WebSocketSession() { AdmissionControl::Instance().ReleaseConnection(); }
+
+    void Run(HttpRequest&& upgrade_request, MessageHandler on_message, CloseHandler on_close = {});
+    void Reject(HttpResponse&& response);
+    void Send(std::shared_ptr<const std::string> message);
+    void Close();
+
+   private:
+    void OnAccept(beast::error_code ec);
+    void Read();
+    void OnRead(beast::error_code ec, [[maybe_unused]] std::size_t bytes_read);
+    void DoWrite();
+    void OnWrite(beast::error_code ec, [[maybe_unused]] std::size_t bytes_written);
+    void DoClose();
+    // Очередь сбрасывается, кроме сообщения, которое сейчас пишется
+    void DropQueued();
+    void Finish();
+
+    enum class State { HANDSHAKE, OPEN, CLOSED };
+
+    websocket::stream<beast::tcp_stream> ws_;
+    beast::flat_buffer buffer_;
+    HttpRequest upgrade_request_;
+    std::deque<std::shared_ptr<const std::string>> queue_;
+    State state_ = State::HANDSHAKE;
+    bool write_in_progress_ = false;
+    // Close пришел во время рукопожатия
+    bool close_requested_ = false;
+    MessageHandler on_message_;
+    CloseHandler on_close_;
+};
+
+// HTTP/1.1 соединение с поддержкой конвейера (pipelining): следующий запрос
+// читается, пока предыдущие еще обрабатываются. Ответы пишутся строго в порядке
+// запросов, не более MAX_PIPELINE запросов одновременно в работе.
+// Строковые ответы сжимаются по Accept-Encoding запроса уже в executor сокета, не на strand API
 class SessionBase {
    protected:
-    using HttpRequest = http::request<http::string_body>;
+    using HttpRequest = http_message::StringRequest;
 
    public:
+    static constexpr size_t MAX_PIPELINE = 8;
+    // Таймаут одного чтения или одной записи. При конвейере они идут одновременно,
+    // поэтому срок выставляется перед каждой операцией, а не один на запрос
+    static constexpr std::chrono::seconds IO_TIMEOUT{30};
+
     SessionBase(const SessionBase&&) = delete;
     SessionBase& operator=(const SessionBase&) = delete;
     void Run();
 
    private:
     void Read();
+    void ReadNext();
 
     void LogRead();
-    void LogWrite(int status_code, std::string_view content_type);
+    // Только в executor сокета
+    void LogWrite(uint64_t seq, int status_code, std::string_view content_type);
 
     void OnRead(beast::error_code ec, [[maybe_unused]] std::size_t bytes_read);
     void Close();
 
-    virtual void HandleRequest(HttpRequest&& request) = 0;
+    // seq - порядковый номер запроса в соединении, с ним же должен прийти ответ в Write
+    // Запрос остается в requests_ до ответа на него
+    virtual void HandleRequest(HttpRequest& request, uint64_t seq) = 0;
+    virtual void HandleUpgrade(HttpRequest&& request) = 0;
     virtual std::shared_ptr<SessionBase> GetSharedThis() = 0;
 
    protected:
-    explicit SessionBase(tcp::socket&& socket, net::io_context& ioc) : stream_(std::move(socket)), ioc_(ioc) {}
-    ~SessionBase() = default;
+    explicit SessionBase(tcp::socket&& socket, net::io_context& ioc)
+        : stream_(std::move(socket)), send_timer_(stream_.get_executor()), request_(http_message::MakeRequest(&memory_)), ioc_(ioc) {}
+    ~SessionBase() {
+        if (owns_connection_)
+            AdmissionControl::Instance().ReleaseConnection();
+    }
+
+    // Сокет забирается у HTTP сессии вместе с местом в лимите соединений, после этого она завершается
+    tcp::socket ReleaseSocket();
 
+    // Может вызываться из любого потока, ответ встает в очередь соединения
     template <typename Body, typename Fields>
-    void Write(http::response<Body, Fields>&& response) {
-        // Запись выполняется асинхронно, поэтому response перемещаем в область
-        // кучи
-        auto content_type = response.at(http::field::content_type);
-        LogWrite(response.result_int(), std::string_view(content_type.data(), content_type.size()));
-
-        auto safe_response = std::make_shared<http::response<Body, Fields>>(std::move(response));
-        auto self = GetSharedThis();
-        http::async_write(stream_, *safe_response, [safe_response, self](beast::error_code ec, std::size_t bytes_written) {
-            self->OnWrite(safe_response->need_eof(), ec, bytes_written);
+    void Write(uint64_t seq, http::response<Body, Fields>&& response) {
+        // Пул соединения не синхронизирован, поэтому с ним работает только executor сокета
+        net::dispatch(stream_.get_executor(), [self = GetSharedThis(), seq, response = std::move(response)]() mutable {
+            auto content_type = response[http::field::content_type];
+            self->LogWrite(seq, response.result_int(), std::string_view(content_type.data(), content_type.size()));
+            if constexpr (std::is_same_v<Body, http::file_body> && std::is_same_v<Fields, http::fields>) {
+                self->QueueWrite(seq, self->MakeFileTransfer(std::move(response)));
+            } else {
+                // Ответ ждет очереди в памяти пула соединения
+                self->QueueWrite(seq, std::allocate_shared<BufferedResponse<Body, Fields>>(http_message::Allocator(&self->memory_), std::move(response)));
+            }
         });
     }
 
    private:
+    // Ответ, ожидающий своей очереди на запись
+    struct PendingResponse {
+        virtual ~PendingResponse() = default;
+        // Вызывается в executor сокета до постановки в очередь
+        virtual void Compress([[maybe_unused]] compression::Encoding encoding) {}
+        // По окончании записи должен быть вызван OnWrite
+        virtual void Start(SessionBase& session) = 0;
+    };
+
+    template <typename Body, typename Fields>
+    struct BufferedResponse : PendingResponse {
+        explicit BufferedResponse(http::response<Body, Fields>&& res) : response(std::move(res)) {}
+
+        void Compress(compression::Encoding encoding) override {
+            if constexpr (std::is_same_v<Body, http::string_body> && std::is_same_v<Fields, http::fields>) 
+                compression::CompressResponse(response, encoding);
+        }
+
+        void Start(SessionBase& session) override {
+            session.stream_.expires_after(IO_TIMEOUT);
+            http::async_write(session.stream_, response, [self = session.GetSharedThis(), close = response.need_eof()](beast::error_code ec, std::size_t bytes_written) {
+                self->OnWrite(close, ec, bytes_written);
+            });
+        }
+
+        http::response<Body, Fields> response;
+    };
+
+    // Тело файла уходит в сокет через sendfile(2): Beast пишет только заголовок,
+    // данные копирует ядро. Если sendfile недоступен - чтение файла кусками
+    struct FileTransfer;
+    std::shared_ptr<PendingResponse> MakeFileTransfer(http::response<http::file_body>&& response);
+    void WriteFileHeader(FileTransfer& transfer);
+    void SendFileBody(FileTransfer& transfer);
+    void WaitWritable(FileTransfer& transfer);
+    void CopyFileBody(FileTransfer& transfer);
+
+    // Только в executor сокета
+    void QueueWrite(uint64_t seq, std::shared_ptr<PendingResponse> pending);
+    void TryWrite();
     void OnWrite(bool close, beast::error_code ec, [[maybe_unused]] std::size_t bytes_written);
 
+    size_t InFlight() const noexcept { return static_cast<size_t>(next_read_seq_ - next_write_seq_); }
+
+    // Память соединения: поля и тело запроса, держатели ответов в очереди. Блоки возвращаются
+    // в пул и переиспользуются, поэтому после первых запросов разбор не обращается к общей куче.
+    // Сами ответы (StringResponse) обработчики собирают в общей куче.
+    // Пул берется и отдается только в executor сокета, поэтому без блокировок
+    // (synchronized_pool_resource к тому же занимает ключ pthread на каждое соединение).
+    // Объявлен первым, чтобы разрушиться последним
+    std::pmr::unsynchronized_pool_resource memory_;
+
     // tcp_stream содержит внутри себя сокет и добавляет поддержку таймаутов
-    std::chrono::time_point<std::chrono::system_clock> _last_received_time_point;
     beast::tcp_stream stream_;
+    // sendfile ждет готовности сокета мимо tcp_stream, поэтому его таймаут отдельный
+    net::steady_timer send_timer_;
     beast::flat_buffer buffer_;
     HttpRequest request_;
     net::io_context& ioc_;
+    std::string remote_ip_;
+
+    // Состояние конвейера, меняется только в executor сокета.
+    // Ответ на запрос seq лежит в ready_[seq % MAX_PIPELINE]
+    std::array<std::shared_ptr<PendingResponse>, MAX_PIPELINE> ready_;
+    // Запрос seq, пока обработчик не ответил на него
+    std::array<std::optional<HttpRequest>, MAX_PIPELINE> requests_;
+    // Время получения запроса seq, от него считается response_time
+    std::array<std::chrono::steady_clock::time_point, MAX_PIPELINE> received_{};
+    // Кодировка, выбранная по Accept-Encoding запроса seq
+    std::array<compression::Encoding, MAX_PIPELINE> encodings_{};
+    std::shared_ptr<PendingResponse> in_flight_;
+    std::optional<HttpRequest> pending_upgrade_;
+    uint64_t next_read_seq_ = 0;
+    uint64_t next_write_seq_ = 0;
+    bool reading_ = false;
+    // Клиент закрыл свою сторону, попросил Connection: close или чтение сломалось - новых запросов не будет
+    bool read_closed_ = false;
+    // Запись сломалась - оставшиеся ответы выбрасываются
+    bool write_failed_ = false;
+    // Место в лимите соединений передано WebSocketSession вместе с сокетом
+    bool owns_connection_ = true;
 };
 
 template <typename RequestHandler>
@@ -84,22 +241,36 @@ class Session : public SessionBase, public std::enable_shared_from_this<Session<
 
    private:
     std::shared_ptr<SessionBase> GetSharedThis() override { return this->shared_from_this(); }
-    void HandleRequest(HttpRequest&& request) override {
-        request_handler_(std::move(request), [self = this->shared_from_this()](auto&& response) {
-            std::visit([self](auto&& arg) { self->Write(std::move(arg)); }, std::move(response));
+    void HandleRequest(HttpRequest& request, uint64_t seq) override {
+        request_handler_(request, [self = this->shared_from_this(), seq](auto&& response) {
+            std::visit([&self, seq](auto&& arg) { self->Write(seq, std::move(arg)); }, std::move(response));
         });
     }
+    void HandleUpgrade(HttpRequest&& request) override {
+        auto ws_session = std::make_shared<WebSocketSession>(ReleaseSocket());
+        // HTTP сессия сейчас завершится вместе со своим пулом, запрос копируется в общую кучу
+        HttpRequest detached_request(request);
+        request_handler_(std::move(detached_request), std::move(ws_session));
+    }
     RequestHandler request_handler_;
 };
 
 template <typename RequestHandler>
 class Listener : public std::enable_shared_from_this<Listener<RequestHandler>> {
    public:
+    // reuse_port - несколько Listener (по одному на ядро) слушают один порт, соединения распределяет ядро ОС
     template <typename Handler>
-    Listener(net::io_context& ioc, const tcp::endpoint& endpoint, Handler&& request_handler)
+    Listener(net::io_context& ioc, const tcp::endpoint& endpoint, Handler&& request_handler, bool reuse_port = false)
         : ioc_(ioc), acceptor_(net::make_strand(ioc)), request_handler_(std::forward<Handler>(request_handler)) {
         acceptor_.open(endpoint.protocol());
         acceptor_.set_option(net::socket_base::reuse_address(true));
+#ifdef SO_REUSEPORT
+        if (reuse_port) 
+            acceptor_.set_option(net::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true));
+#else
+        if (reuse_port) 
+            throw std::runtime_error("SO_REUSEPORT is not supported");
+#endif
         acceptor_.bind(endpoint);
         acceptor_.listen(net::socket_base::max_listen_connections);
     }
@@ -116,10 +287,23 @@ class Listener : public std::enable_shared_from_this<Listener<RequestHandler>> {
             return ReportError(ec, "accept"sv);
         }
 
-        AsyncRunSession(std::move(socket));
+        if (AdmissionControl::Instance().TryAcquireConnection()) 
+            AsyncRunSession(std::move(socket));
+        else 
+            RejectConnection(std::move(socket));
         DoAccept();
     }
 
+    // Соединение сверх лимита получает готовый 503 без чтения запроса
+    void RejectConnection(tcp::socket&& socket) {
+        auto response = AdmissionControl::Instance().ConnectionRejectResponse();
+        auto rejected = std::make_shared<tcp::socket>(std::move(socket));
+        net::async_write(*rejected, net::buffer(*response), [rejected, response](sys::error_code, std::size_t) {
+            sys::error_code ec;
+            rejected->shutdown(tcp::socket::shutdown_send, ec);
+        });
+    }
+
     void AsyncRunSession(tcp::socket&& socket) { std::make_shared<Session<RequestHandler>>(std::move(socket), request_handler_, ioc_)->Run(); }
 
     net::io_context& ioc_;
@@ -128,10 +312,10 @@ class Listener : public std::enable_shared_from_this<Listener<RequestHandler>> {
 };
 
 template <typename RequestHandler>
-void ServeHttp(net::io_context& ioc, const tcp::endpoint& endpoint, RequestHandler&& handler) {
+void ServeHttp(net::io_context& ioc, const tcp::endpoint& endpoint, RequestHandler&& handler, bool reuse_port = false) {
     using MyListener = Listener<std::decay_t<RequestHandler>>;
 
-    std::make_shared<MyListener>(ioc, endpoint, std::forward<RequestHandler>(handler))->Run();
+    std::make_shared<MyListener>(ioc, endpoint, std::forward<RequestHandler>(handler), reuse_port)->Run();
 };
 
 }  // namespace http_server
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "json_request.h"
+
+#include <algorithm>
+#include <boost/json/basic_parser_impl.hpp>
+#include <stdexcept>
+
+namespace json_loader {
+
+namespace json = boost::json;
+
+// Обработчик событий json::basic_parser. Запоминает только скалярные поля
+// объекта верхнего уровня, вложенные значения пропускаются
+class RequestFields::Handler {
+   public:
+    constexpr static std::size_t max_object_size = std::size_t(-1);
+    constexpr static std::size_t max_array_size = std::size_t(-1);
+    constexpr static std::size_t max_key_size = std::size_t(-1);
+    constexpr static std::size_t max_string_size = std::size_t(-1);
+
+    explicit Handler(RequestFields& fields) : fields_(fields), key_(&fields.arena_), value_(&fields.arena_) {}
+
+    bool IsObject() const noexcept { return is_object_; }
+
+    bool on_document_begin(json::error_code&) { return true; }
+    bool on_document_end(json::error_code&) { return true; }
+
+    bool on_object_begin(json::error_code&) {
+        if (depth_ == 0) 
+            is_object_ = true;
+        return Enter();
+    }
+    bool on_object_end(std::size_t, json::error_code&) { return Leave(); }
+    bool on_array_begin(json::error_code&) { return Enter(); }
+    bool on_array_end(std::size_t, json::error_code&) { return Leave(); }
+
+    bool on_key_part(json::string_view part, std::size_t, json::error_code&) { return Append(key_, part); }
+    bool on_key(json::string_view part, std::size_t, json::error_code&) { return Append(key_, part); }
+
+    bool on_string_part(json::string_view part, std::size_t, json::error_code&) { return Append(value_, part); }
+    bool on_string(json::string_view part, std::size_t, json::error_code&) { return Append(value_, part) && Store(); }
+
+    // Число сохраняется в том виде, в каком пришло, как это делал ptree
+    bool on_number_part(json::string_view part, json::error_code&) { return Append(value_, part); }
+    bool on_int64(int64_t, json::string_view part, json::error_code&) { return Append(value_, part) && Store(); }
+    bool on_uint64(uint64_t, json::string_view part, json::error_code&) { return Append(value_, part) && Store(); }
+    bool on_double(double, json::string_view part, json::error_code&) { return Append(value_, part) && Store(); }
+
+    bool on_bool(bool value, json::error_code&) { return Append(value_, value ? "true" : "false") && Store(); }
+    bool on_null(json::error_code&) { return Append(value_, "null") && Store(); }
+
+    bool on_comment_part(json::string_view, json::error_code&) { return true; }
+    bool on_comment(json::string_view, json::error_code&) { return true; }
+
+   private:
+    bool IsField() const noexcept { return depth_ == 1 && is_object_; }
+
+    bool Append(String& out, json::string_view part) {
+        if (IsField()) 
+            out.append(part.data(), part.size());
+        return true;
+    }
+
+    bool Enter() {
+        // Объект или массив в значении поля: ptree отдал бы для него пустую строку
+        if (IsField()) 
+            Store();
+        ++depth_;
+        return true;
+    }
+    bool Leave() {
+        --depth_;
+        return true;
+    }
+
+    bool Store() {
+        if (!IsField()) 
+            return true;
+        auto& fields = fields_.fields_;
+        bool exists = std::any_of(fields.begin(), fields.end(), [this](const auto& field) { return field.first == key_; });
+        if (!exists) 
+            fields.emplace_back(key_, value_);
+        key_.clear();
+        value_.clear();
+        return true;
+    }
+
+    RequestFields& fields_;
+    String key_;
+    String value_;
+    size_t depth_ = 0;
+    bool is_object_ = false;
+};
+
+RequestFields::RequestFields(std::string_view body) : arena_(arena_buffer_, ARENA_SIZE), fields_(&arena_) {
+    json::basic_parser<Handler> parser(json::parse_options(), *this);
+
+    json::error_code ec;
+    auto parsed = parser.write_some(false, body.data(), body.size(), ec);
+    if (ec || parsed != body.size()) 
+        throw std::invalid_argument("request body is not a valid json");
+    if (!parser.handler().IsObject()) 
+        throw std::invalid_argument("request body is not a json object");
+}
+
+std::string RequestFields::Get(std::string_view key) const {
+    for (const auto& [name, value] : fields_) {
+        if (name == key) 
+            return std::string(value);
+    }
+    throw std::invalid_argument("request field not found");
+}
+
+}  // namespace json_loader
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace json_loader {
+
+// Разбор тел небольших запросов (join, action, tick) без ptree и без копий тела.
+// Потоковый парсер Boost.JSON не строит дерево: поля верхнего уровня складываются
+// в арену на стеке, куча задействуется только если они не поместились в ARENA_SIZE.
+// При любой ошибке разбора бросает исключение
+class RequestFields {
+   public:
+    static constexpr size_t ARENA_SIZE = 2048;
+
+    explicit RequestFields(std::string_view body) noexcept(false);
+
+    RequestFields(const RequestFields&) = delete;
+    RequestFields& operator=(const RequestFields&) = delete;
+
+    // Как и ptree::get<std::string>: строка как есть, число или bool - текстом из тела,
+    // объект или массив - пустая строка. При повторе ключа берется первое вхождение
+    std::string Get(std::string_view key) const noexcept(false);
+
+   private:
+    class Handler;
+    using String = std::pmr::string;
+
+    unsigned char arena_buffer_[ARENA_SIZE];
+    std::pmr::monotonic_buffer_resource arena_;
+    std::pmr::vector<std::pair<String, String>> fields_;
+};
+
+}  // namespace json_loader
@@ -0,0 +1,163 @@
+#include "leaderboard.h"
+
+#include <algorithm>
+#include <charconv>
+
+#include "json_loader.h"
+
+namespace app {
+
+using namespace std::literals;
+
+namespace {
+
+constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+// Пусто или UUID в каноническом виде, как его возвращает Postgres
+bool IsRecordId(std::string_view id) {
+    if (id.empty()) 
+        return true;
+    if (id.size() != 36) 
+        return false;
+    for (size_t i = 0; i < id.size(); ++i) {
+        bool dash = i == 8 || i == 13 || i == 18 || i == 23;
+        if (dash ? id[i] != '-' : std::string_view(HEX_DIGITS).find(id[i]) == std::string_view::npos) 
+            return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+std::string EncodeRecordsCursor(const RetiredPlayerInfo& last) {
+    // id не содержит ':', поэтому стоит перед именем
+    auto key = std::to_string(last.score_) + ':' + std::to_string(last.play_time_ms_) + ':' + last.id_ + ':' + last.name_;
+    std::string cursor;
+    cursor.reserve(key.size() * 2);
+    for (unsigned char c : key) {
+        cursor += HEX_DIGITS[c >> 4];
+        cursor += HEX_DIGITS[c & 0xf];
+    }
+    return cursor;
+}
+
+std::optional<RetiredPlayerInfo> DecodeRecordsCursor(std::string_view cursor) {
+    if (cursor.size() % 2 != 0) 
+        return std::nullopt;
+    std::string key;
+    key.reserve(cursor.size() / 2);
+    for (size_t i = 0; i < cursor.size(); i += 2) {
+        unsigned char byte = 0;
+        auto [end, ec] = std::from_chars(cursor.data() + i, cursor.data() + i + 2, byte, 16);
+        if (ec != std::errc() || end != cursor.data() + i + 2) 
+            return std::nullopt;
+        key += static_cast<char>(byte);
+    }
+
+    std::string_view view = key;
+    auto first = view.find(':');
+    auto second = first == std::string_view::npos ? first : view.find(':', first + 1);
+    auto third = second == std::string_view::npos ? second : view.find(':', second + 1);
+    if (third == std::string_view::npos) 
+        return std::nullopt;
+    auto score = ParseRecordInt(view.substr(0, first));
+    auto play_time = ParseRecordInt(view.substr(first + 1, second - first - 1));
+    auto id = view.substr(second + 1, third - second - 1);
+    if (!score || !play_time || !IsRecordId(id)) 
+        return std::nullopt;
+    return RetiredPlayerInfo{std::string(view.substr(third + 1)), *score, *play_time, std::string(id)};
+}
+
+void Leaderboard::Warm(const UseCases::players_list_t& top) {
+    std::lock_guard lock(mutex_);
+    entries_.clear();
+    for (const auto& player : top) {
+        if (entries_.size() == capacity_) 
+            break;
+        entries_.push_back({player, EncodePlayer(player)});
+    }
+    complete_ = top.size() < capacity_;
+    pages_.clear();
+}
+
+void Leaderboard::Add(const RetiredPlayerInfo& player) {
+    if (capacity_ == 0) 
+        return;
+    std::lock_guard lock(mutex_);
+    auto it = std::upper_bound(entries_.begin(), entries_.end(), player,
+                               [](const RetiredPlayerInfo& value, const Entry& entry) { return RecordsLess{}(value, entry.player); });
+    // Ниже всех в полном кеше: в таблице есть не попавшие в кеш записи, которые могут быть выше
+    if (it == entries_.end() && entries_.size() == capacity_) {
+        complete_ = false;
+        return;
+    }
+    entries_.insert(it, {player, EncodePlayer(player)});
+    if (entries_.size() > capacity_) {
+        entries_.pop_back();
+        complete_ = false;
+    }
+    pages_.clear();
+}
+
+std::shared_ptr<const RecordsPage> Leaderboard::Page(size_t offset, size_t limit) const {
+    std::lock_guard lock(mutex_);
+    if (!complete_ && (offset >= entries_.size() || limit > entries_.size() - offset)) 
+        return nullptr;
+
+    if (auto it = pages_.find({offset, limit}); it != pages_.end()) 
+        return it->second;
+
+    if (pages_.size() == MAX_CACHED_PAGES) 
+        pages_.clear();
+    auto page = MakePage(offset, limit);
+    pages_.emplace(std::pair{offset, limit}, page);
+    return page;
+}
+
+std::shared_ptr<const RecordsPage> Leaderboard::PageAfter(const RetiredPlayerInfo& after, size_t limit) const {
+    std::lock_guard lock(mutex_);
+    auto it = std::upper_bound(entries_.begin(), entries_.end(), after,
+                               [](const RetiredPlayerInfo& value, const Entry& entry) { return RecordsLess{}(value, entry.player); });
+    auto offset = static_cast<size_t>(it - entries_.begin());
+    if (!complete_ && (offset >= entries_.size() || limit > entries_.size() - offset)) 
+        return nullptr;
+    return MakePage(offset, limit);
+}
+
+std::shared_ptr<const RecordsPage> Leaderboard::MakePage(size_t offset, size_t limit) const {
+    RecordsPage page{"["s, {}};
+    auto begin = std::min(offset, entries_.size());
+    auto end = begin + std::min(limit, entries_.size() - begin);
+    for (auto i = begin; i < end; ++i) {
+        if (i != begin) 
+            page.json += ",\n"sv;
+        page.json += entries_[i].json;
+    }
+    page.json += begin == end ? "]"sv : "\n]"sv;
+    if (end != begin && end - begin == limit) 
+        page.next_cursor = EncodeRecordsCursor(entries_[end - 1].player);
+    return std::make_shared<const RecordsPage>(std::move(page));
+}
+
+std::string Leaderboard::EncodePlayer(const RetiredPlayerInfo& player) {
+    ptree player_json;
+    player_json.put("name", player.name_);
+    player_json.put("score", player.score_);
+    player_json.put("playTime", player.play_time_ms_ / 1000.0);
+    return json_loader::JsonObject::GetJson(player_json, false);
+}
+
+RecordsPage Leaderboard::EncodePage(const UseCases::players_list_t& players, size_t limit) {
+    RecordsPage page{"["s, {}};
+    for (const auto& player : players) {
+        if (page.json.size() != 1) 
+            page.json += ",\n"sv;
+        page.json += EncodePlayer(player);
+    }
+    page.json += players.empty() ? "]"sv : "\n]"sv;
+    if (!players.empty() && players.size() == limit) 
+        page.next_cursor = EncodeRecordsCursor(players.back());
+    return page;
+}
+
+}  // namespace app
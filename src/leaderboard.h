@@ -0,0 +1,71 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "use_cases.h"
+
+namespace app {
+
+// Курсор таблицы рекордов - ключ сортировки последней записи страницы (вместе с id) в hex,
+// следующая страница начинается сразу после нее
+std::string EncodeRecordsCursor(const RetiredPlayerInfo& last);
+// nullopt - курсор поврежден
+std::optional<RetiredPlayerInfo> DecodeRecordsCursor(std::string_view cursor);
+
+struct RecordsPage {
+    std::string json;
+    // Пусто - страница неполная, дальше записей нет
+    std::string next_cursor;
+};
+
+// Первые K ушедших игроков в памяти, в порядке таблицы рекордов:
+// очки по убыванию, затем время игры, имя и id записи.
+// Прогревается из БД при старте и обновляется при уходе игрока,
+// БД нужна только для страниц глубже K
+class Leaderboard {
+   public:
+    static constexpr size_t DEFAULT_CAPACITY = 1000;
+
+    explicit Leaderboard(size_t capacity = DEFAULT_CAPACITY) : capacity_(capacity) {}
+
+    size_t Capacity() const noexcept { return capacity_; }
+
+    // top - первые Capacity() записей из БД в порядке таблицы рекордов
+    void Warm(const UseCases::players_list_t& top);
+    void Add(const RetiredPlayerInfo& player);
+
+    // nullptr - страница выходит за пределы кеша и нужен запрос к БД
+    std::shared_ptr<const RecordsPage> Page(size_t offset, size_t limit) const;
+    // Страница сразу после записи after
+    std::shared_ptr<const RecordsPage> PageAfter(const RetiredPlayerInfo& after, size_t limit) const;
+
+    static std::string EncodePlayer(const RetiredPlayerInfo& player);
+    static RecordsPage EncodePage(const UseCases::players_list_t& players, size_t limit);
+
+   private:
+    struct Entry {
+        RetiredPlayerInfo player;
+        std::string json;
+    };
+    static constexpr size_t MAX_CACHED_PAGES = 32;
+
+    // Под mutex_
+    std::shared_ptr<const RecordsPage> MakePage(size_t offset, size_t limit) const;
+
+    size_t capacity_;
+    mutable std::mutex mutex_;
+    std::vector<Entry> entries_;
+    // true - в кеше вся таблица, страницы за его концом пустые
+    bool complete_ = true;
+    // Готовые страницы (offset, limit), сбрасываются при изменении таблицы
+    mutable std::map<std::pair<size_t, size_t>, std::shared_ptr<const RecordsPage>> pages_;
+};
+
+}  // namespace app
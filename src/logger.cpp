@@ -3,8 +3,12 @@
 #include <boost/date_time.hpp>
 #include <boost/log/core.hpp>
 #include <boost/log/expressions.hpp>
+#include <boost/log/sinks/basic_sink_backend.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/make_shared.hpp>
 #include <boost/log/utility/setup/common_attributes.hpp>
 
+#include "async_logger.h"
 #include "json_loader.h"
 
 namespace {
@@ -36,11 +40,24 @@ void LogFormatter(logging::record_view const& rec, logging::formatting_ostream&
     strm << json_loader::JsonObject::GetJson(tree, false);
 }
 
+// Записи Boost.Log идут в ту же очередь, что и горячие записи сервера, чтобы не перемешиваться в stdout
+class AsyncQueueBackend : public sinks::basic_formatted_sink_backend<char> {
+   public:
+    void consume(logging::record_view const&, string_type const& line) { async_logger::Logger::Instance().LogRaw(line); }
+};
+
 }  // namespace
 
 void InitBoostLogFilter() {
     logging::add_common_attributes();
 
-    logging::add_console_log(std::cout, keywords::format = &LogFormatter, keywords::auto_flush = true);
-    logging::core::get()->set_filter(logging::trivial::severity >= logging::trivial::info);
+    async_logger::Logger::Instance().Start(nullptr);
+    auto sink = boost::make_shared<sinks::synchronous_sink<AsyncQueueBackend>>();
+    sink->set_formatter(&LogFormatter);
+    logging::core::get()->add_sink(sink);
+    // Уровень категории SERVER можно менять на ходу, см. async_logger::Filter
+    logging::core::get()->set_filter([](const logging::attribute_value_set& values) {
+        auto severity = values[logging::trivial::severity];
+        return severity && async_logger::Filter::Instance().Enabled(async_logger::Category::SERVER, static_cast<async_logger::Level>(*severity));
+    });
 }
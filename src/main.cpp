@@ -3,13 +3,17 @@
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/signal_set.hpp>
+#include <fstream>
 #include <iostream>
 #include <thread>
 
 #include <boost/program_options.hpp>
+#include "async_logger.h"
+#include "executors.h"
 #include "http_server.h"
 #include "json_loader.h"
 #include "logger.h"
+#include "metrics.h"
 #include "request_handler.h"
 #include "time.h"
 #include "auto_data_saver.hpp"
@@ -24,7 +28,17 @@ namespace {
  
 struct Args {
     int tick_period, save_state_period;
-    std::string static_path, config_path, state_file;
+    size_t max_connections = 0, max_pending_requests = 0;
+    std::string static_path, config_path, state_file, log_config;
+    std::string address = "0.0.0.0"s;
+    net::ip::port_type port = 8080;
+    std::string metrics_address = "127.0.0.1"s;
+    net::ip::port_type metrics_port = 0;
+    unsigned threads = 0, io_threads = 0, sim_threads = 1, db_threads = 2;
+    size_t db_max_queue = 64, db_min_connections = 1;
+    int db_timeout = 2000;
+    std::string io_cpus, sim_cpus, db_cpus;
+    std::string records_file;
 };
 
 namespace {
@@ -54,6 +68,26 @@ std::string GetDBUrlFromEnv() {
         ("tick-period,t", po::value(&args.tick_period)->value_name("milliseconds"s), "set tick period")
         ("config-file,c", po::value(&args.config_path)->value_name("file"s), "set config file path")
         ("www-root,w", po::value(&args.static_path)->value_name("dir"s), "set static files root")
+        ("log-config", po::value(&args.log_config)->value_name("file"s), "log levels and sampling per category, reloaded on SIGHUP")
+        ("max-connections", po::value(&args.max_connections)->value_name("count"s), "reply 503 to connections over the limit, 0 - unlimited")
+        ("max-pending-requests", po::value(&args.max_pending_requests)->value_name("count"s), "reply 503 when the API queue is longer, 0 - unlimited")
+        ("address", po::value(&args.address)->value_name("ip"s), "listen address, 0.0.0.0 by default")
+        ("port,p", po::value(&args.port)->value_name("port"s), "listen port, 8080 by default")
+        ("metrics-port", po::value(&args.metrics_port)->value_name("port"s), "serve Prometheus /metrics on a separate port, off by default")
+        ("metrics-address", po::value(&args.metrics_address)->value_name("ip"s), "listen address for --metrics-port, 127.0.0.1 by default")
+        ("threads", po::value(&args.threads)->value_name("count"s), "total threads for all pools, hardware concurrency by default")
+        ("io-threads", po::value(&args.io_threads)->value_name("count"s), "threads accepting connections and serving static files, the rest of --threads by default")
+        ("sim-threads", po::value(&args.sim_threads)->value_name("count"s), "threads running the game strand: ticks and API, 1 by default")
+        ("db-threads", po::value(&args.db_threads)->value_name("count"s), "threads and connections for database writes, 2 by default")
+        ("in-memory-records", "keep the records table in memory instead of Postgres, GAME_DB_URL is not required")
+        ("records-file", po::value(&args.records_file)->value_name("file"s), "with --in-memory-records: append records to this file and load them on start")
+        ("db-min-connections", po::value(&args.db_min_connections)->value_name("count"s), "database connections opened at startup, the rest up to --db-threads on demand, 1 by default")
+        ("db-max-queue", po::value(&args.db_max_queue)->value_name("count"s), "reply 503 to records queries when more database queries are pending, 0 - unlimited, 64 by default")
+        ("db-timeout", po::value(&args.db_timeout)->value_name("milliseconds"s), "reply 503 when a records query takes longer, 0 - no timeout, 2000 by default")
+        ("io-cpus", po::value(&args.io_cpus)->value_name("list"s), "pin io threads to cpus, e.g. 0-3,6")
+        ("sim-cpus", po::value(&args.sim_cpus)->value_name("list"s), "pin game threads to cpus")
+        ("db-cpus", po::value(&args.db_cpus)->value_name("list"s), "pin database threads to cpus")
+        ("thread-per-core", "one pinned io thread per core, each with its own SO_REUSEPORT acceptor")
         ("randomize-spawn-points", "spawn dogs at random positions");
  
     po::variables_map vm;
@@ -76,9 +110,45 @@ std::string GetDBUrlFromEnv() {
         std::cout << requires_fields;
         return std::nullopt;
     }
+    if (args.threads == 0) 
+        args.threads = std::max(1u, std::thread::hardware_concurrency());
+    args.sim_threads = std::max(1u, args.sim_threads);
+    args.db_threads = std::max(1u, args.db_threads);
+    if (!vm.contains("io-threads"s)) 
+        args.io_threads = args.threads > args.sim_threads + args.db_threads ? args.threads - args.sim_threads - args.db_threads : 1;
+    args.io_threads = std::max(1u, args.io_threads);
     return std::pair<Args, po::variables_map>{args,vm};
 }
 
+// SIGHUP - перечитать файл настроек журнала, SIGUSR1 - писать все без выборки
+void ApplyLogConfig(const std::string& path) {
+    auto& filter = async_logger::Filter::Instance();
+    if (path.empty()) {
+        filter.Reset();
+        return;
+    }
+    try {
+        std::ifstream file(path);
+        if (!file) 
+            throw std::invalid_argument("can't open "s + path);
+        filter.Replace(std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()));
+    } catch (const std::exception& ex) {
+        async_logger::Log("log config error"sv, {{"file", path}, {"exception", std::string_view(ex.what())}});
+    }
+}
+
+void WatchLogSignals(net::signal_set& signals, const std::string& path) {
+    signals.async_wait([&signals, &path](const sys::error_code& ec, int signal_number) {
+        if (ec) 
+            return;
+        if (signal_number == SIGHUP) 
+            ApplyLogConfig(path);
+        else 
+            async_logger::Filter::Instance().EnableAll();
+        WatchLogSignals(signals, path);
+    });
+}
+
 template <typename Fn>
 void RunWorkers(unsigned n, const Fn& fn) {
     n = std::max(1u, n);
@@ -104,20 +174,45 @@ int main(int argc, char* argv[]) {
             auto [args, vm] = *opt;
 
             //INITIAL BOOST ASIO
-            const auto address = net::ip::make_address("0.0.0.0");
-            constexpr net::ip::port_type port = 8080;
-            const unsigned num_threads = std::thread::hardware_concurrency();
-            net::io_context ioc(num_threads);
+            const auto address = net::ip::make_address(args.address);
+            const net::ip::port_type port = args.port;
+            const auto io_cpus = executors::ParseCpuList(args.io_cpus);
+            // ioc - сетевые потоки и статика, sim - strand API и тикер, db - запись в БД.
+            // Медленный диск или БД не задерживают тик и движение игроков
+            // В режиме "поток на ядро" ioc обслуживает ядро 0 (сигналы), остальные ядра
+            // только принимают соединения и разбирают запросы
+            const bool thread_per_core = vm.contains("thread-per-core"s);
+            net::io_context ioc(thread_per_core ? 1 : args.io_threads);
+            executors::CoreContexts cores(thread_per_core ? args.io_threads : 1, io_cpus);
+            executors::ThreadPool sim_pool(args.sim_threads, executors::ParseCpuList(args.sim_cpus));
+            executors::ThreadPool db_pool(args.db_threads, executors::ParseCpuList(args.db_cpus));
 
             net::signal_set signals(ioc, SIGINT, SIGTERM);
-            signals.async_wait([&ioc](const sys::error_code& ec, [[maybe_unused]] int signal_number) {
+            signals.async_wait([&ioc, &cores](const sys::error_code& ec, [[maybe_unused]] int signal_number) {
                 if (!ec) {
                     ioc.stop();
+                    cores.Stop();
                 }
             });
 
+            ApplyLogConfig(args.log_config);
+            net::signal_set log_signals(ioc, SIGHUP, SIGUSR1);
+            WatchLogSignals(log_signals, args.log_config);
+
+            http_server::AdmissionControl::Instance().Configure({args.max_connections, args.max_pending_requests});
+
             //APP SETTINGS
-            app::App app(args.config_path, GetDBUrlFromEnv());
+            // Все запросы к БД идут из пула БД, поэтому соединений не больше, чем его потоков
+            app::RecordsStorage records_storage;
+            if (vm.contains("in-memory-records"s)) {
+                records_storage.file = args.records_file;
+            } else {
+                records_storage.db_url = GetDBUrlFromEnv();
+                records_storage.db_pool.min = args.db_min_connections;
+                records_storage.db_pool.max = args.db_threads;
+            }
+            app::App app(args.config_path, records_storage, db_pool.GetExecutor(),
+                         {args.db_max_queue, std::chrono::milliseconds(std::max(0, args.db_timeout))});
 
             std::shared_ptr<data_serializer::DataSaverTimeSyncWithGame> time_sync;
             std::optional<data_serializer::DataSaver> data_saver;
@@ -135,13 +230,31 @@ int main(int argc, char* argv[]) {
                     app.GetMutableGame().GetMutableTimeManager().AddSubscribers(time_sync, 0); //Сохранение в приоретете самое последнее
                 }
             }
+            // Значения читаются при выгрузке /metrics (--metrics-port), она выполняется на strand API
+            auto& registry = metrics::Registry::Instance();
+            registry.AddCallbackGauge("game_sessions", "Active game sessions", [&app] { return double(app.GetGame().GetSessions().size()); });
+            registry.AddCallbackGauge("game_dogs", "Dogs in all sessions", [&app] {
+                size_t dogs = 0;
+                for (const auto& session : app.GetGame().GetSessions()) 
+                    dogs += session->GetCountDogs();
+                return double(dogs);
+            });
+            registry.AddCallbackGauge("db_pending_queries", "Database queries queued or running",
+                                      [&app] { return double(app.GetAsyncUseCaseDB().Pending()); });
+            registry.AddCallbackGauge("game_loot", "Loot objects on all maps", [&app] {
+                size_t loot = 0;
+                for (const auto& session : app.GetGame().GetSessions()) 
+                    loot += session->GetLootObjects().size();
+                return double(loot);
+            });
+
             auto & mutable_game = app.GetMutableGame();
             if(vm.contains("randomize-spawn-points")) 
                 mutable_game.SetRandomizeStart(true);
 
             //Пока strand для api глобальный но в будущем можно пересмотреть
             //и блокировать лишь определенные запросы к разделяемым файлам
-            auto api_strand = net::make_strand(ioc);
+            auto api_strand = net::make_strand(sim_pool.Context());
 
             std::shared_ptr<model::Ticker> ticker(nullptr);
             if(vm.contains("tick-period")) {
@@ -157,24 +270,51 @@ int main(int argc, char* argv[]) {
 
             http_handler::RequestHandler handler(api_strand, api_keeper, args.static_path);
 
-            http_server::ServeHttp(ioc, {address, port}, [&handler](auto&& req, auto&& send) {
+            auto serve = [&handler](auto&& req, auto&& send) {
                 handler(std::forward<decltype(req)>(req), std::forward<decltype(send)>(send));
-            });
+            };
+            http_server::ServeHttp(ioc, {address, port}, serve, thread_per_core);
+            for (size_t core = 0; core < cores.size(); ++core) 
+                http_server::ServeHttp(cores[core], {address, port}, serve, true);
+
+            // Метрики не отдаются на игровом порту, только на отдельном служебном адресе
+            http_handler::MetricsHandler metrics_handler(api_strand);
+            if (args.metrics_port != 0) {
+                http_server::ServeHttp(ioc, {net::ip::make_address(args.metrics_address), args.metrics_port}, [&metrics_handler](auto&& req, auto&& send) {
+                    metrics_handler(std::forward<decltype(req)>(req), std::forward<decltype(send)>(send));
+                });
+            }
 
             BOOST_LOG_TRIVIAL(info) << "server started"
                                     << logging::add_value(additional_data, json_loader::CreateTrivialJson({"port", "address"}, port, address));
 
-            RunWorkers(std::max(1u, num_threads), [&ioc] { ioc.run(); });
+            sim_pool.Start();
+            db_pool.Start();
+            if (thread_per_core) 
+                cores.Run(ioc);
+            else 
+                RunWorkers(args.io_threads, [&ioc, &io_cpus] {
+                    executors::PinCurrentThread(io_cpus);
+                    ioc.run();
+                });
+            // Сначала останавливаем игру, затем дописываем в БД уже отправленные записи
+            sim_pool.Stop();
+            db_pool.Drain();
             if(data_saver) 
                 data_saver->Save();
-        } else 
+        } else {
+            async_logger::Logger::Instance().Stop();
             exit(1);
+        }
     } catch (const std::exception& ex) {
         BOOST_LOG_TRIVIAL(info) << "server exited"
                                 << logging::add_value(additional_data,
                                                       json_loader::CreateTrivialJson({"code", "exception"}, EXIT_FAILURE, ex.what()));
+        // Журнал дописывается явно, не полагаясь на порядок разрушения статических объектов
+        async_logger::Logger::Instance().Stop();
         return EXIT_FAILURE;
     }
     BOOST_LOG_TRIVIAL(info) << "server exited" << logging::add_value(additional_data, json_loader::CreateTrivialJson({"code", "exception"}, 0, ""sv));
+    async_logger::Logger::Instance().Stop();
     return 0;
 }
@@ -0,0 +1,241 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+
+namespace {
+using namespace std::literals;
+
+void AppendNumber(std::string& out, double value) {
+    char buffer[32];
+    auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, end);
+}
+
+void AppendNumber(std::string& out, uint64_t value) {
+    char buffer[24];
+    auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, end);
+}
+
+void AppendHeader(std::string& out, std::string_view name, std::string_view help, std::string_view type) {
+    out.append("# HELP "sv).append(name).append(" "sv).append(help).append("\n# TYPE "sv).append(name).append(" "sv).append(type).append("\n"sv);
+}
+
+// {route="/api/v1/maps",code="200"}, extra - дополнительная метка, например le у корзин гистограммы
+void AppendLabels(std::string& out, const std::vector<std::string>& names, const std::vector<std::string_view>& values,
+                  std::string_view extra_name = {}, std::string_view extra_value = {}) {
+    if (names.empty() && extra_name.empty())
+        return;
+    out += '{';
+    auto append = [&out](std::string_view name, std::string_view value) {
+        if (out.back() != '{')
+            out += ',';
+        out.append(name).append("=\""sv);
+        for (char c : value) {
+            if (c == '\\' || c == '"')
+                out += '\\';
+            if (c == '\n') {
+                out += "\\n"sv;
+                continue;
+            }
+            out += c;
+        }
+        out += '"';
+    };
+    for (size_t i = 0; i < names.size() && i < values.size(); ++i)
+        append(names[i], values[i]);
+    if (!extra_name.empty())
+        append(extra_name, extra_value);
+    out += '}';
+}
+
+}  // namespace
+
+namespace metrics {
+
+size_t ShardIndex() noexcept {
+    static std::atomic<size_t> next_shard = 0;
+    thread_local size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+    return shard;
+}
+
+uint64_t Counter::Value() const noexcept {
+    uint64_t value = 0;
+    for (const auto& shard : shards_)
+        value += shard.value.load(std::memory_order_relaxed);
+    return value;
+}
+
+const std::vector<double>& Histogram::LatencyBuckets() {
+    static const std::vector<double> buckets = {0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10};
+    return buckets;
+}
+
+Histogram::Histogram(std::vector<double> bounds) : bounds_(std::move(bounds)) {
+    if (bounds_.size() > MAX_BUCKETS || !std::is_sorted(bounds_.begin(), bounds_.end()))
+        throw std::invalid_argument("Histogram bounds must be sorted and not exceed MAX_BUCKETS");
+}
+
+void Histogram::Observe(double value) noexcept {
+    auto bucket = static_cast<size_t>(std::lower_bound(bounds_.begin(), bounds_.end(), value) - bounds_.begin());
+    auto& shard = shards_[ShardIndex()];
+    shard.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::Collect() const {
+    Snapshot snapshot;
+    snapshot.buckets.assign(bounds_.size() + 1, 0);
+    for (const auto& shard : shards_) {
+        for (size_t i = 0; i < snapshot.buckets.size(); ++i)
+            snapshot.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+        snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+    }
+    for (auto count : snapshot.buckets)
+        snapshot.count += count;
+    return snapshot;
+}
+
+Registry& Registry::Instance() {
+    static Registry registry;
+    return registry;
+}
+
+Family<Counter>& Registry::AddCounter(std::string name, std::string help, std::vector<std::string> labels) {
+    std::lock_guard lock(mutex_);
+    auto family = std::make_unique<Family<Counter>>(std::move(labels), [] { return std::make_unique<Counter>(); });
+    return *counters_.emplace_back(Entry<Counter>{std::move(name), std::move(help), std::move(family)}).family;
+}
+
+Family<Gauge>& Registry::AddGauge(std::string name, std::string help, std::vector<std::string> labels) {
+    std::lock_guard lock(mutex_);
+    auto family = std::make_unique<Family<Gauge>>(std::move(labels), [] { return std::make_unique<Gauge>(); });
+    return *gauges_.emplace_back(Entry<Gauge>{std::move(name), std::move(help), std::move(family)}).family;
+}
+
+Family<Histogram>& Registry::AddHistogram(std::string name, std::string help, std::vector<std::string> labels, std::vector<double> bounds) {
+    Histogram check(bounds);
+    std::lock_guard lock(mutex_);
+    auto family = std::make_unique<Family<Histogram>>(std::move(labels), [bounds = std::move(bounds)] { return std::make_unique<Histogram>(bounds); });
+    return *histograms_.emplace_back(Entry<Histogram>{std::move(name), std::move(help), std::move(family)}).family;
+}
+
+void Registry::AddCallbackGauge(std::string name, std::string help, std::function<double()> callback) {
+    std::lock_guard lock(mutex_);
+    callbacks_.push_back({std::move(name), std::move(help), std::move(callback)});
+}
+
+std::string Registry::Serialize() const {
+    std::lock_guard lock(mutex_);
+    std::string out;
+
+    for (const auto& [name, help, family] : counters_) {
+        AppendHeader(out, name, help, "counter"sv);
+        family->ForEach([&](const std::vector<std::string_view>& values, const Counter& counter) {
+            out += name;
+            AppendLabels(out, family->LabelNames(), values);
+            out += ' ';
+            AppendNumber(out, counter.Value());
+            out += '\n';
+        });
+    }
+
+    for (const auto& [name, help, family] : gauges_) {
+        AppendHeader(out, name, help, "gauge"sv);
+        family->ForEach([&](const std::vector<std::string_view>& values, const Gauge& gauge) {
+            out += name;
+            AppendLabels(out, family->LabelNames(), values);
+            out += ' ';
+            AppendNumber(out, static_cast<double>(gauge.Value()));
+            out += '\n';
+        });
+    }
+    for (const auto& [name, help, callback] : callbacks_) {
+        AppendHeader(out, name, help, "gauge"sv);
+        out.append(name).append(" "sv);
+        AppendNumber(out, callback());
+        out += '\n';
+    }
+
+    for (const auto& [name, help, family] : histograms_) {
+        AppendHeader(out, name, help, "histogram"sv);
+        family->ForEach([&](const std::vector<std::string_view>& values, const Histogram& histogram) {
+            auto snapshot = histogram.Collect();
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i < snapshot.buckets.size(); ++i) {
+                cumulative += snapshot.buckets[i];
+                std::string le = "+Inf"s;
+                if (i < histogram.Bounds().size()) {
+                    le.clear();
+                    AppendNumber(le, histogram.Bounds()[i]);
+                }
+                out.append(name).append("_bucket"sv);
+                AppendLabels(out, family->LabelNames(), values, "le"sv, le);
+                out += ' ';
+                AppendNumber(out, cumulative);
+                out += '\n';
+            }
+            out.append(name).append("_sum"sv);
+            AppendLabels(out, family->LabelNames(), values);
+            out += ' ';
+            AppendNumber(out, snapshot.sum);
+            out.append("\n"sv).append(name).append("_count"sv);
+            AppendLabels(out, family->LabelNames(), values);
+            out += ' ';
+            AppendNumber(out, snapshot.count);
+            out += '\n';
+        });
+    }
+    return out;
+}
+
+Family<Histogram>& RequestDuration() {
+    static auto& family = Registry::Instance().AddHistogram("http_request_duration_seconds", "Time from request received to response ready",
+                                                            {"route", "code"});
+    return family;
+}
+
+Histogram& StrandWait() {
+    static auto& histogram = Registry::Instance().AddHistogram("api_strand_wait_seconds", "Time an API request waits for the game strand").Get();
+    return histogram;
+}
+
+Family<Histogram>& TickDuration() {
+    static auto& family = Registry::Instance().AddHistogram("game_tick_duration_seconds", "Game tick duration by phase", {"phase"});
+    return family;
+}
+
+Histogram& DbPoolWait() {
+    static auto& histogram = Registry::Instance().AddHistogram("db_pool_wait_seconds", "Time waiting for a free database connection").Get();
+    return histogram;
+}
+
+Gauge& DbPoolOpen() {
+    static auto& gauge = Registry::Instance().AddGauge("db_pool_connections", "Open database connections, including checked out").Get();
+    return gauge;
+}
+
+Gauge& DbPoolCheckedOut() {
+    static auto& gauge = Registry::Instance().AddGauge("db_pool_checked_out", "Database connections in use").Get();
+    return gauge;
+}
+
+Counter& DbReconnects() {
+    static auto& counter = Registry::Instance().AddCounter("db_pool_reconnects_total", "Broken database connections replaced on checkout").Get();
+    return counter;
+}
+
+Histogram& SaveDuration() {
+    static auto& histogram = Registry::Instance().AddHistogram("state_save_duration_seconds", "Game state save duration").Get();
+    return histogram;
+}
+
+Family<Counter>& RejectedRequests() {
+    static auto& family =
+        Registry::Instance().AddCounter("http_rejected_total", "Requests and connections rejected with 503", {"reason", "priority"});
+    return family;
+}
+
+}  // namespace metrics
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+////////////////////////////////////////////////
+//// Метрики сервера в формате Prometheus
+////////////////////////////////////////////////
+
+namespace metrics {
+
+// Каждый поток пишет в свою часть счетчика, чтобы потоки не делили кеш-линию.
+// Сумма собирается только при чтении
+constexpr size_t SHARDS = 16;
+size_t ShardIndex() noexcept;
+
+class Counter {
+   public:
+    void Inc(uint64_t value = 1) noexcept { shards_[ShardIndex()].value.fetch_add(value, std::memory_order_relaxed); }
+    uint64_t Value() const noexcept;
+
+   private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value = 0;
+    };
+    std::array<Shard, SHARDS> shards_;
+};
+
+class Gauge {
+   public:
+    void Set(int64_t value) noexcept { value_.store(value, std::memory_order_relaxed); }
+    void Add(int64_t value) noexcept { value_.fetch_add(value, std::memory_order_relaxed); }
+    int64_t Value() const noexcept { return value_.load(std::memory_order_relaxed); }
+
+   private:
+    std::atomic<int64_t> value_ = 0;
+};
+
+// Гистограмма с фиксированными границами корзин, значения в секундах
+class Histogram {
+   public:
+    static constexpr size_t MAX_BUCKETS = 16;
+    using Clock = std::chrono::steady_clock;
+
+    // Границы по умолчанию: от 0.5 мс до 10 с
+    static const std::vector<double>& LatencyBuckets();
+
+    explicit Histogram(std::vector<double> bounds);
+
+    void Observe(double value) noexcept;
+    void Observe(Clock::duration duration) noexcept { Observe(std::chrono::duration<double>(duration).count()); }
+    void ObserveSince(Clock::time_point start) noexcept { Observe(Clock::now() - start); }
+
+    struct Snapshot {
+        // Не накопительные, последний элемент - +Inf
+        std::vector<uint64_t> buckets;
+        double sum = 0;
+        uint64_t count = 0;
+    };
+    Snapshot Collect() const;
+    const std::vector<double>& Bounds() const noexcept { return bounds_; }
+
+   private:
+    struct alignas(64) Shard {
+        std::array<std::atomic<uint64_t>, MAX_BUCKETS + 1> buckets{};
+        std::atomic<double> sum = 0;
+    };
+
+    std::vector<double> bounds_;
+    std::array<Shard, SHARDS> shards_;
+};
+
+// Метрика с набором меток. Экземпляр для новых значений меток создается при первом обращении
+template <typename Metric>
+class Family {
+   public:
+    using Factory = std::function<std::unique_ptr<Metric>()>;
+
+    Family(std::vector<std::string> label_names, Factory factory) : label_names_(std::move(label_names)), factory_(std::move(factory)) {}
+
+    // Значения в порядке label_names. Ссылка действительна всю жизнь семейства
+    Metric& WithLabels(std::initializer_list<std::string_view> values);
+    Metric& Get() { return WithLabels({}); }
+
+    const std::vector<std::string>& LabelNames() const noexcept { return label_names_; }
+
+    // fn(значения меток, метрика) в порядке значений меток
+    template <typename Fn>
+    void ForEach(Fn&& fn) const;
+
+   private:
+    static constexpr char SEPARATOR = '\x1f';
+
+    std::vector<std::string> label_names_;
+    Factory factory_;
+    mutable std::shared_mutex mutex_;
+    std::map<std::string, std::unique_ptr<Metric>, std::less<>> metrics_;
+};
+
+class Registry {
+   public:
+    static Registry& Instance();
+
+    Family<Counter>& AddCounter(std::string name, std::string help, std::vector<std::string> labels = {});
+    Family<Gauge>& AddGauge(std::string name, std::string help, std::vector<std::string> labels = {});
+    Family<Histogram>& AddHistogram(std::string name, std::string help, std::vector<std::string> labels = {},
+                                    std::vector<double> bounds = Histogram::LatencyBuckets());
+    // Значение вычисляется в момент выгрузки, в потоке, который ее запросил
+    void AddCallbackGauge(std::string name, std::string help, std::function<double()> callback);
+
+    // Текстовый формат Prometheus 0.0.4
+    std::string Serialize() const;
+
+   private:
+    template <typename Metric>
+    struct Entry {
+        std::string name;
+        std::string help;
+        std::unique_ptr<Family<Metric>> family;
+    };
+    struct CallbackEntry {
+        std::string name;
+        std::string help;
+        std::function<double()> callback;
+    };
+
+    mutable std::mutex mutex_;
+    std::vector<Entry<Counter>> counters_;
+    std::vector<Entry<Gauge>> gauges_;
+    std::vector<Entry<Histogram>> histograms_;
+    std::vector<CallbackEntry> callbacks_;
+};
+
+// Метрики сервера, регистрируются при первом обращении
+Family<Histogram>& RequestDuration();  // route, code
+Histogram& StrandWait();
+Family<Histogram>& TickDuration();  // phase
+Histogram& DbPoolWait();
+Gauge& DbPoolOpen();
+Gauge& DbPoolCheckedOut();
+Counter& DbReconnects();
+Histogram& SaveDuration();
+Family<Counter>& RejectedRequests();  // reason, priority
+
+constexpr std::string_view CONTENT_TYPE = "text/plain; version=0.0.4; charset=utf-8";
+
+template <typename Metric>
+Metric& Family<Metric>::WithLabels(std::initializer_list<std::string_view> values) {
+    thread_local std::string key;
+    key.clear();
+    for (auto value : values) {
+        key.append(value);
+        key += SEPARATOR;
+    }
+    {
+        std::shared_lock lock(mutex_);
+        if (auto it = metrics_.find(key); it != metrics_.end())
+            return *it->second;
+    }
+    std::unique_lock lock(mutex_);
+    auto& metric = metrics_[key];
+    if (!metric)
+        metric = factory_();
+    return *metric;
+}
+
+template <typename Metric>
+template <typename Fn>
+void Family<Metric>::ForEach(Fn&& fn) const {
+    std::shared_lock lock(mutex_);
+    std::vector<std::string_view> values;
+    for (const auto& [key, metric] : metrics_) {
+        values.clear();
+        for (size_t pos = 0, end; (end = key.find(SEPARATOR, pos)) != std::string::npos; pos = end + 1)
+            values.push_back(std::string_view(key).substr(pos, end - pos));
+        fn(values, *metric);
+    }
+}
+
+}  // namespace metrics
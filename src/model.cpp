@@ -308,6 +308,7 @@ std::shared_ptr<GameSession> Game::AddSession(Map::Id id) {
         session->request_to_save_retired_player_s.connect([this](std::string a1, int a2, int a3) { 
             request_to_save_retired_player_s(std::move(a1),a2,a3); 
         });
+        session->tick_completed_s.connect([this](const GameSession& session) { session_tick_completed_s(session); });
         time_manager_.AddSubscribers(session, 10);
         sessions_.push_back(session);
         return session;
@@ -316,6 +317,7 @@ std::shared_ptr<GameSession> Game::AddSession(Map::Id id) {
 }
 
 void Game::AddSession(std::shared_ptr<GameSession> game_session) {
+    game_session->tick_completed_s.connect([this](const GameSession& session) { session_tick_completed_s(session); });
     sessions_.push_back(game_session);
     time_manager_.AddSubscribers(game_session, 10);
 }
@@ -495,6 +497,8 @@ void GameSession::Tick(const std::chrono::milliseconds& ms) {
             TakeLoot(event.gatherer_id,id_loot);
         }
     }
+
+    tick_completed_s(*this);
 }
 
 bool GameSession::TakeLoot(int id_dog, int id_loot) {
@@ -233,7 +233,7 @@ class Dog : public TimeObject {
     bool MoveDog(Direction);
     void StopDog();
 
-    char GetDirectionChar() { return static_cast<char>(direction_); }
+    char GetDirectionChar() const { return static_cast<char>(direction_); }
 
     // TIME SUPPORT
     void Tick(const std::chrono::milliseconds& ms) override;
@@ -339,6 +339,8 @@ class GameSession : public TimeObject {
     size_t GetCountDogs() { return dogs_.size(); }
    public:
     boost::signals2::signal<void(std::string, int, int)> request_to_save_retired_player_s;
+    // Вызывается в конце каждого тика сессии, когда состояние уже пересчитано
+    boost::signals2::signal<void(const GameSession&)> tick_completed_s;
 
    private:
 
@@ -452,6 +454,7 @@ class Game : public json_loader::JsonObject {
     std::shared_ptr<loot_gen::LootGenerator> GetMutableLootGenerator() { return loot_generator_; }
    public:
     boost::signals2::signal<void(std::string, int, int)> request_to_save_retired_player_s;
+    boost::signals2::signal<void(const GameSession&)> session_tick_completed_s;
    private:
     using MapIdHasher = util::TaggedHasher<Map::Id>;
     using MapIdToIndex = std::unordered_map<Map::Id, size_t, MapIdHasher>;
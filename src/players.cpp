@@ -32,13 +32,13 @@ std::pair<std::shared_ptr<Player>, util::Token> Players::AddPlayer(std::string_v
     auto dog = game_session->AddDog(dog_name);
 
     auto player = std::make_shared<Player>(game_session, dog);
-    players_[token] = player;
+    players_.Insert(token, player);
     return {player, token};
 }
 std::shared_ptr<Player> Players::FindByDogAndMapId(model::Dog::Id dog_id, const model::Map::Id& map_id) { return nullptr; }
 std::shared_ptr<Player> Players::FindByToken(const util::Token& token) const {
-    auto it = players_.find(token);
-    return it == players_.end() ? nullptr : it->second;
+    auto player = players_.Find(token);
+    return player ? *player : nullptr;
 }
 void Players::MovePlayer(const util::Token& token, std::string_view direction) const noexcept(false) {
     auto player = GetPlayerWithCheck(token);
@@ -46,7 +46,7 @@ void Players::MovePlayer(const util::Token& token, std::string_view direction) c
         player->dog_->StopDog();
     }
     if (direction.size() == 1) {
-        if (!GetPlayerWithCheck(token)->dog_->MoveDog(static_cast<model::Direction>(direction.back()))) throw ec::BAD_REQUEST;
+        if (!player->dog_->MoveDog(static_cast<model::Direction>(direction.back()))) throw ec::BAD_REQUEST;
     }
 }
 std::shared_ptr<Player> Players::GetPlayerWithCheck(const util::Token& token) const noexcept(false) {
@@ -54,11 +54,7 @@ std::shared_ptr<Player> Players::GetPlayerWithCheck(const util::Token& token) co
     if (!player) 
         throw ec::AUTHORIZATION_NOT_FOUND;
     if(player->dog_->IsExited()) {
-        auto it = std::find_if(players_.begin(), players_.end(),
-                       [&](const auto& pair) { return pair.second == player; });
-        if (it != players_.end()) {
-            players_.erase(it);
-        }               
+        players_.Erase(token);
         throw ec::AUTHORIZATION_NOT_FOUND;
     }
     return player;
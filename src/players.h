@@ -1,8 +1,7 @@
 #pragma once
 
-#include <map>
-
 #include "model.h"
+#include "token_table.h"
 
 namespace app {
 
@@ -13,7 +12,7 @@ struct Player {
 
 class Players {
    public:
-    using Players_t = std::map<util::Token, std::shared_ptr<Player>>;
+    using Players_t = util::TokenTable<std::shared_ptr<Player>>;
     explicit Players(model::Game& game);
 
     const std::vector<std::shared_ptr<model::Dog>>& GetListDogInRoom(const util::Token&) const noexcept(false);
@@ -29,9 +28,11 @@ class Players {
         players_ = players;
     }
 
-   private:
+    // Игрок по токену, ушедшие на покой удаляются и считаются неавторизованными
     std::shared_ptr<Player> GetPlayerWithCheck(const util::Token&) const noexcept(false);
 
+   private:
+
     mutable Players_t players_;
     model::Game& game_;
 };
@@ -1,6 +1,6 @@
 #include "postgres.h"
 
-#include <thread>
+#include <mutex>
 #include <pqxx/zview.hxx>
 #include <pqxx/pqxx>
 #include <pqxx/transaction>
@@ -11,16 +11,15 @@ namespace postgres {
 using namespace std::literals;    
 using pqxx::operator"" _zv;
 
-Database::Database(const std::string & db_url)  
-: pool_{
-    std::thread::hardware_concurrency(),
-    [db_url] {
-        auto conn = std::make_shared<pqxx::connection>(db_url);
-        return conn;
-    }
-} {
-    auto connection = pool_.GetConnection();
-    pqxx::work work{*connection};
+namespace {
+
+// Имена подготовленных запросов, регистрируются на каждом соединении пула
+constexpr char INSERT_RETIRED[] = "insert_retired_player";
+constexpr char RECORDS_PAGE[] = "retired_players_page";
+constexpr char RECORDS_AFTER[] = "retired_players_after";
+
+void CreateSchema(pqxx::connection & connection) {
+    pqxx::work work{connection};
 
     work.exec(R"(
     CREATE TABLE IF NOT EXISTS retired_players (
@@ -30,21 +29,53 @@ Database::Database(const std::string & db_url)
     play_time_ms int NOT NULL
     ); )"_zv);
 
-    work.exec("CREATE INDEX IF NOT EXISTS sort_retired_players ON retired_players(score DESC, play_time_ms, name)"_zv);
+    // Имена сравниваются побайтно (COLLATE "C"), как в Leaderboard::Less и std::string.
+    // Иначе порядок зависит от локали базы, и курсор страниц пропускает или повторяет записи.
+    // id - уникальный последний ключ, чтобы курсор различал записи с одинаковыми очками, временем и именем
+    work.exec("DROP INDEX IF EXISTS sort_retired_players"_zv);
+    work.exec("DROP INDEX IF EXISTS sort_retired_players_c"_zv);
+    work.exec(R"(CREATE INDEX IF NOT EXISTS sort_retired_players_key ON retired_players(score DESC, play_time_ms, name COLLATE "C", id))"_zv);
 
     work.commit();
 }
 
+// Сервер разбирает и планирует запрос один раз на соединение, дальше передаются только параметры
+void PrepareStatements(pqxx::connection & connection) {
+    connection.prepare(INSERT_RETIRED, "INSERT INTO retired_players VALUES ($1,$2,$3,$4);"_zv);
+    connection.prepare(RECORDS_PAGE,
+        "SELECT id, name, score, play_time_ms FROM retired_players ORDER BY score DESC, play_time_ms, name COLLATE \"C\", id OFFSET $1 LIMIT $2;"_zv);
+    // Направления столбцов разные, поэтому сравнение строк (a, b, c) > (...) не подходит.
+    // score <= $1 - граница диапазона в индексе sort_retired_players_key, остальное условие
+    // отсекает только записи с тем же счетом до курсора, поэтому глубина страницы не важна
+    connection.prepare(RECORDS_AFTER,
+        "SELECT id, name, score, play_time_ms FROM retired_players "
+        "WHERE score <= $1 AND (score < $1 OR (play_time_ms, name COLLATE \"C\", id) > ($2, $3, $4::uuid)) "
+        "ORDER BY score DESC, play_time_ms, name COLLATE \"C\", id LIMIT $5;"_zv);
+}
+
+}  // namespace
+
+Database::Database(const std::string & db_url, const ConnectionPool::Limits & pool_limits)  
+: pool_{
+    pool_limits,
+    [db_url, schema = std::make_shared<std::once_flag>()] {
+        auto conn = std::make_shared<pqxx::connection>(db_url);
+        // Таблица должна существовать до подготовки запросов к ней
+        std::call_once(*schema, [&conn] { CreateSchema(*conn); });
+        return conn;
+    },
+    PrepareStatements
+} {
+}
+
 domain::RetiredPlayerRepository::retired_players_t RetiredPlayerRepositoryImpl::GetSortedRetiredPlayersList(int offset, int limit) {
     pqxx::read_transaction tx{*connection_}; 
 
     retired_players_t players;
-    auto size = std::get<0>(tx.query1<int>("SELECT count(*) FROM retired_players;"));
-    players.reserve(size);
-    auto query = "SELECT name, score, play_time_ms FROM retired_players ORDER BY score DESC, play_time_ms, name OFFSET "s 
-                  + std::to_string(offset) + " LIMIT "s +std::to_string(limit) + ";"s;
-    for(auto [name, score, time] : tx.query<std::string, int, int>(pqxx::zview(query))) {
-        players.push_back(domain::RetiredPlayer(name, score, time));
+    players.reserve(limit);
+    auto result = tx.exec_prepared(RECORDS_PAGE, offset, limit);
+    for(auto [id, name, score, time] : result.iter<std::string, std::string, int, int>()) {
+        players.push_back(domain::RetiredPlayer(name, score, time, id));
     }
 
     BOOST_LOG_TRIVIAL(debug) << "DataBase: " << "GetSortedRetiredPlayersList " << players.size();
@@ -52,14 +83,28 @@ domain::RetiredPlayerRepository::retired_players_t RetiredPlayerRepositoryImpl::
     return players;
 }
 
+domain::RetiredPlayerRepository::retired_players_t RetiredPlayerRepositoryImpl::GetSortedRetiredPlayersAfter(int score, int play_time_ms, 
+                                                                                                         const std::string & name, const std::string & id, int limit) {
+    pqxx::read_transaction tx{*connection_}; 
+
+    retired_players_t players;
+    players.reserve(limit);
+    auto result = tx.exec_prepared(RECORDS_AFTER, score, play_time_ms, name, id, limit);
+    for(auto [player_id, player_name, player_score, player_time] : result.iter<std::string, std::string, int, int>()) {
+        players.push_back(domain::RetiredPlayer(player_name, player_score, player_time, player_id));
+    }
+
+    BOOST_LOG_TRIVIAL(debug) << "DataBase: " << "GetSortedRetiredPlayersAfter " << players.size();
+
+    return players;
+}
+
 void RetiredPlayerRepositoryImpl::AddRetriedPlayer(const domain::RetiredPlayer& player) {
     pqxx::transaction tx{*connection_};
 
     BOOST_LOG_TRIVIAL(debug) << "DataBase: " << "INSERT";
 
-    tx.exec_params("INSERT INTO retired_players VALUES ($1,$2,$3,$4);",
-    player.GetId(),player.GetName(),player.GetScore(),player.GetPlayTimeMs()
-    );
+    tx.exec_prepared(INSERT_RETIRED, player.GetId(), player.GetName(), player.GetScore(), player.GetPlayTimeMs());
 
     tx.commit();
 }
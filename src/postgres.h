@@ -18,6 +18,7 @@ public:
     }
 
     retired_players_t GetSortedRetiredPlayersList(int offset, int limit) override;
+    retired_players_t GetSortedRetiredPlayersAfter(int score, int play_time_ms, const std::string & name, const std::string & id, int limit) override;
     virtual void AddRetriedPlayer(const domain::RetiredPlayer & player) override;
 private:
     ConnectionUnit connection_;
@@ -25,9 +26,10 @@ private:
 
 class Database {
 public:
-    explicit Database(const std::string & db_url);
+    Database(const std::string & db_url, const ConnectionPool::Limits & pool_limits);
 
     ConnectionUnit GetConnection() { return pool_.GetConnection(); }
+    ConnectionPool::Stats GetPoolStats() const { return pool_.GetStats(); }
 private:
     ConnectionPool pool_;
 };
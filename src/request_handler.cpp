@@ -1,5 +1,7 @@
 #include "request_handler.h"
 
+#include <charconv>
+
 using namespace std::literals;
 namespace beast = boost::beast;
 namespace sys = boost::system;
@@ -8,26 +10,30 @@ namespace fs = std::filesystem;
 namespace http_handler {
 
 RequestHandler::RequestHandler(strand_t & api_strand, api::ApiProxyKeeper& keeper, std::string_view static_folder)
-    : static_folder_(static_folder), file_system_redirection_(static_folder), api_strand_(api_strand) {
-        redirection_pack_[ContentType::API_TYPE] = std::make_shared<ApiRedirection>(keeper);
+    : api_strand_(api_strand), file_system_redirection_(static_folder), static_folder_(static_folder) {
+        keeper.RegisterRoutes(routes_, upgrade_routes_);
     }
 
 void RequestHandler::PreSettings(StringRequest& req) {
-    req.target(util::EncodeURL(util::ToSV(req.target())));
     if (req.target() == "/") 
         req.target(util::ToBSV(ContentType::INDEX_HTML));
+    // Цель декодируется целиком до поиска маршрута: id карты в API может прийти в %-кодировке
+    else if (util::ToSV(req.target()).find_first_of("%+"sv) != std::string_view::npos) 
+        req.target(util::ToBSV(util::EncodeURL(util::ToSV(req.target()))));
 }
 
-std::shared_ptr<BasicRedirection> RequestHandler::ExtractRequestRedirection(Args_t &args) {
-    auto it = redirection_pack_.end();
-    if (!args.empty()) {
-        it = redirection_pack_.find(args.front());
-    }
-    if (it != redirection_pack_.end()) {
-        args.pop_front();
-        return it->second;
-    }
-    return nullptr;
+void RequestHandler::ObserveRequest(std::string_view route, unsigned code, metrics::Histogram::Clock::time_point received) {
+    char code_label[8];
+    auto [end, ec] = std::to_chars(code_label, code_label + sizeof(code_label), code);
+    metrics::RequestDuration().WithLabels({route, std::string_view(code_label, end - code_label)}).ObserveSince(received);
+}
+
+bool RequestHandler::IsApiTarget(std::string_view target) {
+    auto pos = target.find_first_not_of('/');
+    if (pos == std::string_view::npos) 
+        return false;
+    target.remove_prefix(pos);
+    return target.substr(0, target.find_first_of("/?")) == ContentType::API_TYPE;
 }
 
 }  // namespace http_handler
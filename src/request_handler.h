@@ -3,17 +3,18 @@
 #include <boost/asio.hpp>
 #include <optional>
 
-#include "api.h"
+#include "api_proxy.h"
 #include "error_codes.h"
 #include "headers.h"
+#include "http_server.h"
 #include "request_redirection.h"
 #include "common.h"
+#include "metrics.h"
 
 namespace http_handler {
 
 namespace http = boost::beast::http;
 namespace net = boost::asio;
-using RedirectionPack = std::map<std::string_view, std::shared_ptr<BasicRedirection>>;
 
 template <class Base, class T, class... Args>
 std::unique_ptr<Base> static inline MakeUnique(Args&&... args) {
@@ -27,50 +28,158 @@ class RequestHandler {
     RequestHandler(const RequestHandler&) = delete;
     RequestHandler& operator=(const RequestHandler&) = delete;
 
+    // Запрос принадлежит соединению и живет до вызова send, освобождает его само соединение
     template <typename Body, typename Allocator, typename Send>
-    void operator()(http::request<Body, http::basic_fields<Allocator>>&& req, Send&& send) {
-        //send(HandleRequest(std::forward<decltype(req)>(req)));
-
+    void operator()(http::request<Body, http::basic_fields<Allocator>>& req, Send&& send) {
+        auto received = metrics::Histogram::Clock::now();
         PreSettings(req);
-        auto args = util::SplitUrl(util::ToSV(req.target()));
         auto resp_var = util::GetBasicResponse(req);
-        //Здесь должен был полифорфизм переадресации корневого сегмента,
-        //но strand немного поменял правила, позже вернуть 
-        auto redirection = ExtractRequestRedirection(args);
-        if(redirection) {
-            net::dispatch(api_strand_, [args = std::move(args), redirection, send = std::move(send), req = std::forward<decltype(req)>(req),
-                                         resp = std::forward<decltype(resp_var)>(resp_var)]() mutable {
+
+        // Поиск маршрута делается в потоке ввода-вывода, на strand уходит только сам вызов обработчика
+        auto match = routes_.Find(req.method(), util::ToSV(req.target()));
+        auto& admission = http_server::AdmissionControl::Instance();
+        if (match && !admission.TryEnterQueue(http_server::AdmissionControl::ClassifyRoute(match->pattern))) 
+            return Reject(resp_var, received, match->pattern, std::forward<Send>(send));
+        if (match) {
+            net::dispatch(api_strand_, [match = std::move(*match), send = std::move(send), &req,
+                                         resp = std::forward<decltype(resp_var)>(resp_var), received]() mutable {
+                http_server::AdmissionControl::Instance().LeaveQueue();
+                metrics::StrandWait().ObserveSince(received);
+                // Сжатие выполняет соединение в своем executor, strand API занят только обработкой
+                DeferredSend deferred([send, route = match.pattern, head = match.head_as_get, received](StringResponse&& deferred_resp) mutable {
+                    if (head) 
+                        deferred_resp.body().clear();
+                    ObserveRequest(route, deferred_resp.result_int(), received);
+                    send(message_pack_t(std::move(deferred_resp)));
+                });
+                auto& string_resp = std::get<StringResponse>(resp);
                 try {
-                    redirection->Redirect(std::move(args), resp, req);
+                    if (!match.handler) 
+                        throw MakeAllowError(match.allowed_verbs);
+                    match.params.Bind(util::ToSV(req.target()));
+                    (*match.handler)(HttpResource(req, string_resp, match.params, deferred));
+                    if (match.head_as_get) 
+                        string_resp.body().clear();
                 } catch (const ErrorCode& ec) {
                     // TODO STACK TRACE IN ASYNC CODE
-                    FillInfoError(std::get<StringResponse>(resp), ec);
+                    FillInfoError(string_resp, ec);
                 } catch (const std::exception& ec) {
-                    FillInfoError(std::get<StringResponse>(resp), ErrorCode::UNKNOWN_ERROR, ec.what());
+                    FillInfoError(string_resp, ErrorCode::UNKNOWN_ERROR, ec.what());
                 }
-                send(resp);     
+                if (deferred.IsDeferred()) 
+                    return;
+                ObserveRequest(match.pattern, string_resp.result_int(), received);
+                send(resp);
             });
-        } else {
+            return;
+        }
+        if (!admission.Admit(http_server::AdmissionControl::Priority::LOW)) 
+            return Reject(resp_var, received, STATIC_ROUTE, std::forward<Send>(send));
+
+        try {
+            if (IsApiTarget(util::ToSV(req.target()))) 
+                throw ErrorCode::BAD_REQUEST;
+            file_system_redirection_.Redirect(util::SplitUrl(util::ToSV(req.target())), resp_var, req, nullptr);
+        } catch (const ErrorCode& ec) {
+            FillInfoError(std::get<StringResponse>(resp_var), ec);
+        } catch (const std::exception& ec) {
+            FillInfoError(std::get<StringResponse>(resp_var), ErrorCode::UNKNOWN_ERROR, ec.what());
+        }
+        ObserveRequest(STATIC_ROUTE, std::visit([](const auto& resp) { return resp.result_int(); }, resp_var), received);
+        send(resp_var);
+    }
+
+    // Запрос на переключение протокола (WebSocket), ответ уходит через сам ws
+    void operator()(StringRequest&& req, std::shared_ptr<http_server::WebSocketSession> ws) {
+        auto match = upgrade_routes_.Find(req.method(), util::ToSV(req.target()));
+        net::dispatch(api_strand_, [match = std::move(match), req = std::move(req), ws = std::move(ws)]() mutable {
             try {
-                file_system_redirection_.Redirect(std::move(args), resp_var, req);
+                if (!match) 
+                    throw ErrorCode::BAD_REQUEST;
+                if (!match->handler) 
+                    throw MakeAllowError(match->allowed_verbs);
+                match->params.Bind(util::ToSV(req.target()));
+                (*match->handler)(req, match->params, ws);
+                return;
             } catch (const ErrorCode& ec) {
-                FillInfoError(std::get<StringResponse>(resp_var), ec);
+                auto resp = util::GetBasicResponse(req);
+                FillInfoError(std::get<StringResponse>(resp), ec);
+                ws->Reject(std::move(std::get<StringResponse>(resp)));
             } catch (const std::exception& ec) {
-                FillInfoError(std::get<StringResponse>(resp_var), ErrorCode::UNKNOWN_ERROR, ec.what());
+                auto resp = util::GetBasicResponse(req);
+                FillInfoError(std::get<StringResponse>(resp), ErrorCode::UNKNOWN_ERROR, ec.what());
+                ws->Reject(std::move(std::get<StringResponse>(resp)));
             }
-            send(resp_var);
-        }
+        });
     }
 
    private:
+    template <typename Send>
+    static void Reject(message_pack_t& resp_var, metrics::Histogram::Clock::time_point received, std::string_view route, Send&& send) {
+        auto& resp = std::get<StringResponse>(resp_var);
+        FillInfoError(resp, ErrorCode::SERVICE_UNAVAILABLE);
+        resp.set(http::field::retry_after, std::to_string(http_server::AdmissionControl::Instance().GetLimits().retry_after.count()));
+        ObserveRequest(route, resp.result_int(), received);
+        send(resp_var);
+    }
+
+    // Метка маршрута для статики и неизвестных путей, чтобы число меток не зависело от запросов
+    static constexpr std::string_view STATIC_ROUTE = "static";
+
     void PreSettings(StringRequest& req);
+    static bool IsApiTarget(std::string_view target);
+    static void ObserveRequest(std::string_view route, unsigned code, metrics::Histogram::Clock::time_point received);
 
     strand_t & api_strand_;
 
-    std::shared_ptr<BasicRedirection> ExtractRequestRedirection(Args_t& args);
+    // Таблицы заполняются один раз в конструкторе, дальше только чтение из разных потоков
+    api::Routes routes_;
+    api::UpgradeRoutes upgrade_routes_;
     FilesystemRedirection file_system_redirection_;
-    RedirectionPack redirection_pack_;
     std::string_view static_folder_;
 };
 
+// Отдельный служебный адрес (--metrics-port): внутренние данные сервера не видны игрокам на игровом порту.
+// Выгрузка выполняется на strand API, поэтому функции метрик могут читать состояние игры
+class MetricsHandler {
+   public:
+    static constexpr std::string_view TARGET = "/metrics";
+
+    explicit MetricsHandler(strand_t & api_strand) : api_strand_(api_strand) {}
+
+    MetricsHandler(const MetricsHandler&) = delete;
+    MetricsHandler& operator=(const MetricsHandler&) = delete;
+
+    template <typename Body, typename Allocator, typename Send>
+    void operator()(http::request<Body, http::basic_fields<Allocator>>& req, Send&& send) {
+        auto resp_var = util::GetBasicResponse(req);
+        auto& resp = std::get<StringResponse>(resp_var);
+        if (util::ToSV(req.target()) != TARGET) {
+            FillInfoError(resp, ErrorCode::FILE_NOT_EXIST);
+            return send(resp_var);
+        }
+        if (req.method() != http::verb::get && req.method() != http::verb::head) {
+            FillInfoError(resp, MakeAllowError(router::VerbBit(http::verb::get) | router::VerbBit(http::verb::head)));
+            return send(resp_var);
+        }
+        net::dispatch(api_strand_, [send = std::forward<Send>(send), resp_var = std::move(resp_var), head = req.method() == http::verb::head]() mutable {
+            auto& resp = std::get<StringResponse>(resp_var);
+            resp.set(http::field::content_type, util::ToBSV(metrics::CONTENT_TYPE));
+            util::FillBody(resp, metrics::Registry::Instance().Serialize());
+            if (head) 
+                resp.body().clear();
+            send(resp_var);
+        });
+    }
+
+    void operator()(StringRequest&& req, std::shared_ptr<http_server::WebSocketSession> ws) {
+        auto resp = util::GetBasicResponse(req);
+        FillInfoError(std::get<StringResponse>(resp), ErrorCode::BAD_REQUEST);
+        ws->Reject(std::move(std::get<StringResponse>(resp)));
+    }
+
+   private:
+    strand_t & api_strand_;
+};
+
 }  // namespace http_handler
@@ -1,6 +1,7 @@
 #include "request_redirection.h"
 
 #include "common.h"
+#include "error_codes.h"
 
 
 namespace http_handler {
@@ -9,19 +10,15 @@ namespace {
 namespace http = boost::beast::http;
 }
 
-ApiRedirection::ApiRedirection(api::ApiProxyKeeper& api_keeper) : api_keeper_(api_keeper) {}
+FilesystemRedirection::FilesystemRedirection(std::string_view static_folder) : static_folder_(static_folder), cache_(static_folder) {}
 
-void ApiRedirection::Redirect(Args_t&& args, message_pack_t& resp, const StringRequest& req) {
-    auto& api_resp = std::get<StringResponse>(resp);
-    auto version = util::ExtractArg(args);
-    auto api_ptr = api_keeper_.GetMutableApiByVersion(version);
-    api_ptr->HandleApi(HttpResource(req, api_resp, std::move(args)));
-}
-
-FilesystemRedirection::FilesystemRedirection(std::string_view static_folder) : static_folder_(static_folder) {}
-
-void FilesystemRedirection::Redirect(Args_t&& args, message_pack_t& resp, const StringRequest& req) {
+void FilesystemRedirection::Redirect(Args_t&& args, message_pack_t& resp, const StringRequest& req, DeferredSend*) {
     auto path = util::GetUrlByArgs(args);
+    if (auto entry = cache_.Find(path)) {
+        resp = StaticCache::MakeResponse(*entry, req);
+        return;
+    }
+    // Не попавшие в кеш (крупные или появившиеся после старта) читаются с диска
     util::ReadFileToBuffer(resp, path, static_folder_);
 }
 
@@ -2,37 +2,27 @@
 
 #include <string_view>
 
-#include "api_proxy.h"
 #include "headers.h"
+#include "static_cache.h"
 
 namespace http_handler {
 
-// Маршрутизатор корневых запросов по облокам программы
-// Является фасадом ко всем частям программы API и файловой системе
+// Обработка запросов, не попавших в таблицу маршрутов API
 
 class BasicRedirection {
    public:
-    virtual void Redirect(Args_t&& args, message_pack_t& resp, const StringRequest& req) = 0;
-};
-
-class ApiRedirection : public BasicRedirection {
-   public:
-    explicit ApiRedirection(api::ApiProxyKeeper& api_keeper);
-
-    void Redirect(Args_t&&, message_pack_t& resp, const StringRequest& req) override;
-
-   private:
-    api::ApiProxyKeeper& api_keeper_;
+    virtual void Redirect(Args_t&& args, message_pack_t& resp, const StringRequest& req, DeferredSend* deferred) = 0;
 };
 
 class FilesystemRedirection : public BasicRedirection {
    public:
     explicit FilesystemRedirection(std::string_view static_folder);
 
-    void Redirect(Args_t&&, message_pack_t& resp, const StringRequest& req) override;
+    void Redirect(Args_t&&, message_pack_t& resp, const StringRequest& req, DeferredSend* deferred) override;
 
    private:
     std::string_view static_folder_;
+    StaticCache cache_;
 };
 
 }  // namespace http_handler
\ No newline at end of file
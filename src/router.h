@@ -0,0 +1,185 @@
+#pragma once
+
+#include <boost/beast/http/verb.hpp>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////
+//// Маршрутизация запросов по заранее собранному дереву
+////////////////////////////////////////////////////////
+
+namespace router {
+
+namespace http = boost::beast::http;
+
+constexpr uint64_t VerbBit(http::verb verb) { return uint64_t(1) << static_cast<unsigned>(verb); }
+
+// Параметры пути и строка запроса. Хранятся смещения внутри target,
+// поэтому после перемещения запроса их нужно привязать к новому target через Bind
+class Params {
+   public:
+    static constexpr size_t MAX_PARAMS = 4;
+
+    std::string_view operator[](size_t index) const { return target_.substr(params_[index].first, params_[index].second); }
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    // Все что после '?', без декодирования
+    std::string_view Query() const { return target_.substr(query_.first, query_.second); }
+
+    void Bind(std::string_view target) noexcept { target_ = target; }
+
+    bool Push(size_t offset, size_t length) noexcept {
+        if (size_ == MAX_PARAMS)
+            return false;
+        params_[size_++] = {static_cast<uint32_t>(offset), static_cast<uint32_t>(length)};
+        return true;
+    }
+    void SetQuery(size_t offset, size_t length) noexcept { query_ = {static_cast<uint32_t>(offset), static_cast<uint32_t>(length)}; }
+
+   private:
+    std::string_view target_;
+    std::array<std::pair<uint32_t, uint32_t>, MAX_PARAMS> params_{};
+    std::pair<uint32_t, uint32_t> query_{0, 0};
+    size_t size_ = 0;
+};
+
+// Префиксное дерево сегментов пути. Маршруты добавляются только при старте,
+// поиск выполняется за один проход по target без выделения памяти.
+// Шаблон маршрута: "/api/v1/maps/{id}", сегмент в фигурных скобках - параметр
+template <typename Handler>
+class Router {
+   public:
+    struct Match {
+        // nullptr - путь известен, но метод не поддерживается, см. allowed_verbs
+        const Handler* handler = nullptr;
+        uint64_t allowed_verbs = 0;
+        // HEAD обслуживается обработчиком GET, тело ответа нужно очистить
+        bool head_as_get = false;
+        // Шаблон маршрута, например "/api/v1/maps/{id}" - метка для метрик
+        std::string_view pattern;
+        Params params;
+    };
+
+    void Add(http::verb verb, std::string_view pattern, Handler handler) {
+        uint32_t node = ROOT;
+        ForEachSegment(pattern, [&](std::string_view segment, size_t) {
+            node = segment.front() == '{' && segment.back() == '}' ? AddParamChild(node) : AddLiteralChild(node, segment);
+            return true;
+        });
+
+        auto& leaf = nodes_[node];
+        if (leaf.pattern.empty())
+            leaf.pattern = pattern;
+        for (const auto& [existing_verb, _] : leaf.handlers) {
+            if (existing_verb == verb)
+                throw std::invalid_argument("Duplicate route " + std::string(pattern));
+        }
+        leaf.handlers.emplace_back(verb, std::move(handler));
+        leaf.allowed_verbs |= VerbBit(verb);
+        if (verb == http::verb::get)
+            leaf.allowed_verbs |= VerbBit(http::verb::head);
+    }
+
+    std::optional<Match> Find(http::verb verb, std::string_view target) const noexcept {
+        Match match;
+
+        auto query_pos = target.find('?');
+        if (query_pos != std::string_view::npos)
+            match.params.SetQuery(query_pos + 1, target.size() - query_pos - 1);
+
+        uint32_t node = ROOT;
+        bool found = ForEachSegment(target.substr(0, query_pos), [&](std::string_view segment, size_t offset) {
+            node = Step(node, segment, offset, match.params);
+            return node != NONE;
+        });
+        if (!found || nodes_[node].allowed_verbs == 0)
+            return std::nullopt;
+
+        const auto& leaf = nodes_[node];
+        match.allowed_verbs = leaf.allowed_verbs;
+        match.pattern = leaf.pattern;
+        match.handler = FindHandler(leaf, verb);
+        if (!match.handler && verb == http::verb::head) {
+            match.handler = FindHandler(leaf, http::verb::get);
+            match.head_as_get = match.handler != nullptr;
+        }
+        match.params.Bind(target);
+        return match;
+    }
+
+   private:
+    static constexpr uint32_t ROOT = 0;
+    static constexpr uint32_t NONE = ~uint32_t(0);
+
+    struct Node {
+        std::vector<std::pair<std::string, uint32_t>> literals;
+        uint32_t param = NONE;
+        std::vector<std::pair<http::verb, Handler>> handlers;
+        uint64_t allowed_verbs = 0;
+        std::string pattern;
+    };
+
+    // Пустые сегменты пропускаются: "/api//v1/" эквивалентно "/api/v1"
+    template <typename Fn>
+    static bool ForEachSegment(std::string_view path, Fn&& fn) {
+        size_t pos = 0;
+        while (pos < path.size()) {
+            size_t end = path.find('/', pos);
+            if (end == std::string_view::npos)
+                end = path.size();
+            if (end != pos && !fn(path.substr(pos, end - pos), pos))
+                return false;
+            pos = end + 1;
+        }
+        return true;
+    }
+
+    uint32_t Step(uint32_t node, std::string_view segment, size_t offset, Params& params) const noexcept {
+        const auto& current = nodes_[node];
+        for (const auto& [literal, child] : current.literals) {
+            if (literal == segment)
+                return child;
+        }
+        if (current.param != NONE && params.Push(offset, segment.size()))
+            return current.param;
+        return NONE;
+    }
+
+    static const Handler* FindHandler(const Node& node, http::verb verb) noexcept {
+        for (const auto& [handler_verb, handler] : node.handlers) {
+            if (handler_verb == verb)
+                return &handler;
+        }
+        return nullptr;
+    }
+
+    uint32_t AddLiteralChild(uint32_t node, std::string_view segment) {
+        for (const auto& [literal, child] : nodes_[node].literals) {
+            if (literal == segment)
+                return child;
+        }
+        auto child = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+        nodes_[node].literals.emplace_back(std::string(segment), child);
+        return child;
+    }
+
+    uint32_t AddParamChild(uint32_t node) {
+        if (nodes_[node].param == NONE) {
+            nodes_[node].param = static_cast<uint32_t>(nodes_.size());
+            nodes_.emplace_back();
+        }
+        return nodes_[node].param;
+    }
+
+    std::vector<Node> nodes_ = std::vector<Node>(1);
+};
+
+}  // namespace router
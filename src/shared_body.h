@@ -0,0 +1,36 @@
+#pragma once
+
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/optional.hpp>
+#include <memory>
+#include <string>
+
+// Тело ответа, разделяющее буфер с кешем: запись в сокет идет прямо из
+// общей строки, без копирования в каждый ответ
+struct SharedBufferBody {
+    using value_type = std::shared_ptr<const std::string>;
+
+    static std::uint64_t size(const value_type& body) { return body ? body->size() : 0; }
+
+    class writer {
+       public:
+        using const_buffers_type = boost::asio::const_buffer;
+
+        template <bool isRequest, class Fields>
+        writer(const boost::beast::http::header<isRequest, Fields>&, const value_type& body) : body_(body) {}
+
+        void init(boost::beast::error_code& ec) { ec = {}; }
+
+        boost::optional<std::pair<const_buffers_type, bool>> get(boost::beast::error_code& ec) {
+            ec = {};
+            if (!body_ || body_->empty()) 
+                return boost::none;
+            return {{const_buffers_type(body_->data(), body_->size()), false}};
+        }
+
+       private:
+        const value_type& body_;
+    };
+};
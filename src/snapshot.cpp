@@ -0,0 +1,383 @@
+#include "snapshot.h"
+
+#include <bit>
+#include <boost/crc.hpp>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace data_serializer::snapshot {
+
+namespace {
+
+enum class Section : uint32_t {
+    STRINGS = 1,
+    SESSIONS = 2,
+    DOGS = 3,
+    BAGS = 4,
+    LOOT = 5,
+    PLAYERS = 6,
+};
+
+// magic, версия, число секций, размер остатка, CRC32 остатка
+constexpr size_t HEADER_SIZE = 4 + 2 + 2 + 8 + 4;
+
+class Writer {
+   public:
+    template <typename T>
+    void Put(T value) {
+        using U = std::make_unsigned_t<T>;
+        auto bits = static_cast<U>(value);
+        for (size_t i = 0; i < sizeof(T); ++i) 
+            data_ += static_cast<char>((bits >> (8 * i)) & 0xff);
+    }
+    void PutDouble(double value) { Put(std::bit_cast<uint64_t>(value)); }
+    void PutBytes(std::string_view bytes) { data_.append(bytes); }
+
+    // Длина секции записывается после ее содержимого
+    size_t BeginSection(Section tag) {
+        Put(static_cast<uint32_t>(tag));
+        Put(uint64_t{0});
+        return data_.size();
+    }
+    void EndSection(size_t begin) {
+        auto size = static_cast<uint64_t>(data_.size() - begin);
+        for (size_t i = 0; i < sizeof(size); ++i) 
+            data_[begin - sizeof(size) + i] = static_cast<char>((size >> (8 * i)) & 0xff);
+    }
+
+    std::string& Data() { return data_; }
+
+   private:
+    std::string data_;
+};
+
+class Reader {
+   public:
+    explicit Reader(std::string_view data) : data_(data) {}
+
+    template <typename T>
+    T Get() {
+        auto bytes = GetBytes(sizeof(T));
+        std::make_unsigned_t<T> bits = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) 
+            bits |= static_cast<std::make_unsigned_t<T>>(static_cast<unsigned char>(bytes[i])) << (8 * i);
+        return static_cast<T>(bits);
+    }
+    double GetDouble() { return std::bit_cast<double>(Get<uint64_t>()); }
+    std::string_view GetBytes(size_t size) {
+        if (size > data_.size() - pos_) 
+            throw std::runtime_error("Snapshot is truncated");
+        auto bytes = data_.substr(pos_, size);
+        pos_ += size;
+        return bytes;
+    }
+    // Число записей, каждая не короче record_size: защита от огромного reserve по испорченному счетчику
+    uint32_t GetCount(size_t record_size) {
+        auto count = Get<uint32_t>();
+        if (count > (data_.size() - pos_) / record_size) 
+            throw std::runtime_error("Snapshot record count is damaged");
+        return count;
+    }
+    bool Empty() const noexcept { return pos_ == data_.size(); }
+
+   private:
+    std::string_view data_;
+    size_t pos_ = 0;
+};
+
+class StringTable {
+   public:
+    uint32_t Add(const std::string& value) {
+        auto [it, inserted] = index_.try_emplace(value, static_cast<uint32_t>(strings_.size()));
+        if (inserted) 
+            strings_.push_back(&it->first);
+        return it->second;
+    }
+    const std::vector<const std::string*>& Strings() const noexcept { return strings_; }
+
+   private:
+    std::unordered_map<std::string, uint32_t> index_;
+    std::vector<const std::string*> strings_;
+};
+
+uint32_t Crc(std::string_view data) {
+    boost::crc_32_type crc;
+    crc.process_bytes(data.data(), data.size());
+    return crc.checksum();
+}
+
+constexpr size_t SESSION_SIZE = 4 + 8 + 4 + 4 + 1 + 4 + 4;
+constexpr size_t DOG_SIZE = 8 + 4 + 8 * 5 + 1 + 8 + 4 + 4;
+constexpr size_t BAG_ITEM_SIZE = 4 + 4;
+constexpr size_t LOOT_SIZE = 4 + 4 + 8 + 8;
+constexpr size_t PLAYER_SIZE = 8 + 8 + 4 + 4;
+
+}  // namespace
+
+bool IsBinary(std::string_view data) noexcept {
+    return data.substr(0, MAGIC.size()) == MAGIC;
+}
+
+std::string Encode(const Snapshot& snapshot) {
+    StringTable strings;
+    size_t dogs = 0, bag_items = 0, loot = 0;
+    for (const auto& session : snapshot.sessions) {
+        strings.Add(session.map_id);
+        for (const auto& dog : session.dogs) {
+            strings.Add(dog.name);
+            bag_items += dog.bag.size();
+        }
+        dogs += session.dogs.size();
+        loot += session.loot.size();
+    }
+
+    Writer writer;
+    writer.Data().reserve(HEADER_SIZE + 6 * (4 + 8 + 4) + snapshot.sessions.size() * SESSION_SIZE + dogs * (DOG_SIZE + 16) +
+                          bag_items * BAG_ITEM_SIZE + loot * LOOT_SIZE + snapshot.players.size() * PLAYER_SIZE);
+    writer.PutBytes(MAGIC);
+    writer.Put(VERSION);
+    writer.Put(uint16_t{6});
+    writer.Put(uint64_t{0});
+    writer.Put(uint32_t{0});
+
+    auto section = writer.BeginSection(Section::STRINGS);
+    writer.Put(static_cast<uint32_t>(strings.Strings().size()));
+    for (const auto* value : strings.Strings()) {
+        writer.Put(static_cast<uint32_t>(value->size()));
+        writer.PutBytes(*value);
+    }
+    writer.EndSection(section);
+
+    section = writer.BeginSection(Section::SESSIONS);
+    writer.Put(static_cast<uint32_t>(snapshot.sessions.size()));
+    for (const auto& session : snapshot.sessions) {
+        writer.Put(strings.Add(session.map_id));
+        writer.PutDouble(session.default_speed);
+        writer.Put(session.bag_capacity);
+        writer.Put(session.last_id_object);
+        writer.Put(static_cast<uint8_t>(session.randomize_start));
+        writer.Put(static_cast<uint32_t>(session.dogs.size()));
+        writer.Put(static_cast<uint32_t>(session.loot.size()));
+    }
+    writer.EndSection(section);
+
+    section = writer.BeginSection(Section::DOGS);
+    writer.Put(static_cast<uint32_t>(dogs));
+    for (const auto& session : snapshot.sessions) {
+        for (const auto& dog : session.dogs) {
+            writer.Put(dog.id);
+            writer.Put(strings.Add(dog.name));
+            writer.PutDouble(dog.x);
+            writer.PutDouble(dog.y);
+            writer.PutDouble(dog.speed_x);
+            writer.PutDouble(dog.speed_y);
+            writer.PutDouble(dog.map_speed);
+            writer.Put(static_cast<uint8_t>(dog.direction));
+            writer.Put(dog.score);
+            writer.Put(dog.bag_capacity);
+            writer.Put(static_cast<uint32_t>(dog.bag.size()));
+        }
+    }
+    writer.EndSection(section);
+
+    section = writer.BeginSection(Section::BAGS);
+    writer.Put(static_cast<uint32_t>(bag_items));
+    for (const auto& session : snapshot.sessions) {
+        for (const auto& dog : session.dogs) {
+            for (auto [id, type] : dog.bag) {
+                writer.Put(static_cast<int32_t>(id));
+                writer.Put(static_cast<int32_t>(type));
+            }
+        }
+    }
+    writer.EndSection(section);
+
+    section = writer.BeginSection(Section::LOOT);
+    writer.Put(static_cast<uint32_t>(loot));
+    for (const auto& session : snapshot.sessions) {
+        for (const auto& item : session.loot) {
+            writer.Put(item.id);
+            writer.Put(item.type);
+            writer.PutDouble(item.x);
+            writer.PutDouble(item.y);
+        }
+    }
+    writer.EndSection(section);
+
+    section = writer.BeginSection(Section::PLAYERS);
+    writer.Put(static_cast<uint32_t>(snapshot.players.size()));
+    for (const auto& player : snapshot.players) {
+        writer.Put(player.token_hi);
+        writer.Put(player.token_lo);
+        writer.Put(player.session);
+        writer.Put(player.dog);
+    }
+    writer.EndSection(section);
+
+    auto& data = writer.Data();
+    std::string_view payload = std::string_view(data).substr(HEADER_SIZE);
+    Writer header;
+    header.Put(static_cast<uint64_t>(payload.size()));
+    header.Put(Crc(payload));
+    data.replace(HEADER_SIZE - header.Data().size(), header.Data().size(), header.Data());
+    return std::move(data);
+}
+
+Snapshot Decode(std::string_view data) {
+    if (!IsBinary(data)) 
+        throw std::runtime_error("Not a binary snapshot");
+    Reader header(data.substr(0, HEADER_SIZE));
+    header.GetBytes(MAGIC.size());
+    if (auto version = header.Get<uint16_t>(); version > VERSION) 
+        throw std::runtime_error("Snapshot version " + std::to_string(version) + " is not supported");
+    auto section_count = header.Get<uint16_t>();
+    auto payload_size = header.Get<uint64_t>();
+    auto crc = header.Get<uint32_t>();
+    auto payload = data.substr(HEADER_SIZE);
+    if (payload.size() != payload_size || Crc(payload) != crc) 
+        throw std::runtime_error("Snapshot checksum mismatch");
+
+    std::vector<std::string> strings;
+    std::vector<std::pair<uint32_t, uint32_t>> session_sizes;  // собаки, предметы
+    Snapshot snapshot;
+    std::vector<uint32_t> bag_sizes;
+    bool has_dogs = false, has_bags = false, has_loot = false;
+
+    auto string_at = [&strings](uint32_t index) -> const std::string& {
+        if (index >= strings.size()) 
+            throw std::runtime_error("Snapshot string index is damaged");
+        return strings[index];
+    };
+    auto expect_total = [](size_t count, size_t expected) {
+        if (count != expected) 
+            throw std::runtime_error("Snapshot sections do not match");
+    };
+    auto total = [&session_sizes](auto field) {
+        size_t sum = 0;
+        for (const auto& sizes : session_sizes) 
+            sum += sizes.*field;
+        return sum;
+    };
+
+    Reader reader(payload);
+    for (uint16_t i = 0; i < section_count; ++i) {
+        auto tag = static_cast<Section>(reader.Get<uint32_t>());
+        auto size = reader.Get<uint64_t>();
+        if (size > payload.size()) 
+            throw std::runtime_error("Snapshot section size is damaged");
+        Reader section(reader.GetBytes(static_cast<size_t>(size)));
+
+        switch (tag) {
+            case Section::STRINGS: {
+                auto count = section.GetCount(4);
+                strings.reserve(count);
+                for (uint32_t s = 0; s < count; ++s) 
+                    strings.emplace_back(section.GetBytes(section.Get<uint32_t>()));
+                break;
+            }
+            case Section::SESSIONS: {
+                auto count = section.GetCount(SESSION_SIZE);
+                snapshot.sessions.resize(count);
+                session_sizes.resize(count);
+                for (uint32_t s = 0; s < count; ++s) {
+                    auto& session = snapshot.sessions[s];
+                    session.map_id = string_at(section.Get<uint32_t>());
+                    session.default_speed = section.GetDouble();
+                    session.bag_capacity = section.Get<int32_t>();
+                    session.last_id_object = section.Get<int32_t>();
+                    session.randomize_start = section.Get<uint8_t>() != 0;
+                    session_sizes[s] = {section.Get<uint32_t>(), section.Get<uint32_t>()};
+                }
+                break;
+            }
+            case Section::DOGS: {
+                auto count = section.GetCount(DOG_SIZE);
+                expect_total(count, total(&std::pair<uint32_t, uint32_t>::first));
+                bag_sizes.reserve(count);
+                for (size_t s = 0; s < snapshot.sessions.size(); ++s) {
+                    auto& dogs = snapshot.sessions[s].dogs;
+                    dogs.resize(session_sizes[s].first);
+                    for (auto& dog : dogs) {
+                        dog.id = section.Get<uint64_t>();
+                        dog.name = string_at(section.Get<uint32_t>());
+                        dog.x = section.GetDouble();
+                        dog.y = section.GetDouble();
+                        dog.speed_x = section.GetDouble();
+                        dog.speed_y = section.GetDouble();
+                        dog.map_speed = section.GetDouble();
+                        dog.direction = static_cast<char>(section.Get<uint8_t>());
+                        dog.score = section.Get<uint64_t>();
+                        dog.bag_capacity = section.Get<int32_t>();
+                        bag_sizes.push_back(section.Get<uint32_t>());
+                    }
+                }
+                has_dogs = true;
+                break;
+            }
+            case Section::BAGS: {
+                if (!has_dogs) 
+                    throw std::runtime_error("Snapshot bags precede dogs");
+                auto count = section.GetCount(BAG_ITEM_SIZE);
+                size_t expected = 0;
+                for (auto bag_size : bag_sizes) 
+                    expected += bag_size;
+                expect_total(count, expected);
+                size_t dog_index = 0;
+                for (auto& session : snapshot.sessions) {
+                    for (auto& dog : session.dogs) {
+                        dog.bag.reserve(bag_sizes[dog_index]);
+                        for (uint32_t b = 0; b < bag_sizes[dog_index]; ++b) {
+                            auto id = section.Get<int32_t>();
+                            dog.bag.emplace_back(id, section.Get<int32_t>());
+                        }
+                        ++dog_index;
+                    }
+                }
+                has_bags = true;
+                break;
+            }
+            case Section::LOOT: {
+                auto count = section.GetCount(LOOT_SIZE);
+                expect_total(count, total(&std::pair<uint32_t, uint32_t>::second));
+                for (size_t s = 0; s < snapshot.sessions.size(); ++s) {
+                    auto& loot = snapshot.sessions[s].loot;
+                    loot.resize(session_sizes[s].second);
+                    for (auto& item : loot) {
+                        item.id = section.Get<int32_t>();
+                        item.type = section.Get<int32_t>();
+                        item.x = section.GetDouble();
+                        item.y = section.GetDouble();
+                    }
+                }
+                has_loot = true;
+                break;
+            }
+            case Section::PLAYERS: {
+                auto count = section.GetCount(PLAYER_SIZE);
+                snapshot.players.resize(count);
+                for (auto& player : snapshot.players) {
+                    player.token_hi = section.Get<uint64_t>();
+                    player.token_lo = section.Get<uint64_t>();
+                    player.session = section.Get<uint32_t>();
+                    player.dog = section.Get<uint32_t>();
+                }
+                break;
+            }
+            default:
+                // Секции из более новых версий пропускаются
+                continue;
+        }
+        if (!section.Empty()) 
+            throw std::runtime_error("Snapshot section has trailing data");
+    }
+
+    if (!snapshot.sessions.empty() && !(has_dogs && has_bags && has_loot)) 
+        throw std::runtime_error("Snapshot sections are missing");
+    for (const auto& player : snapshot.players) {
+        if (player.session >= snapshot.sessions.size() || player.dog >= snapshot.sessions[player.session].dogs.size()) 
+            throw std::runtime_error("Snapshot player refers to a missing dog");
+    }
+    return snapshot;
+}
+
+}  // namespace data_serializer::snapshot
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////
+//// Двоичный снимок состояния игры для DataSaver
+////////////////////////////////////////////////
+
+namespace data_serializer::snapshot {
+
+// Заголовок: "GSNP", версия, число секций, размер остатка файла и его CRC32.
+// Секция: тег, длина, содержимое. Записи собак, предметов и игроков фиксированного размера,
+// строки (имена, id карт) хранятся один раз в таблице строк и задаются ее индексом.
+// Все числа little-endian
+constexpr std::string_view MAGIC = "GSNP";
+constexpr uint16_t VERSION = 1;
+
+struct DogRecord {
+    uint64_t id = 0;
+    std::string name;
+    double x = 0, y = 0;
+    double speed_x = 0, speed_y = 0;
+    double map_speed = 0;
+    char direction = 'U';
+    uint64_t score = 0;
+    int32_t bag_capacity = 0;
+    // id, тип
+    std::vector<std::pair<int, int>> bag;
+};
+
+struct LootRecord {
+    int32_t id = 0;
+    int32_t type = 0;
+    double x = 0, y = 0;
+};
+
+struct SessionRecord {
+    std::string map_id;
+    double default_speed = 0;
+    int32_t bag_capacity = 0;
+    int32_t last_id_object = 0;
+    bool randomize_start = false;
+    std::vector<DogRecord> dogs;
+    std::vector<LootRecord> loot;
+};
+
+struct PlayerRecord {
+    uint64_t token_hi = 0, token_lo = 0;
+    // Индекс сессии в Snapshot::sessions и собаки в ее dogs
+    uint32_t session = 0;
+    uint32_t dog = 0;
+};
+
+struct Snapshot {
+    std::vector<SessionRecord> sessions;
+    std::vector<PlayerRecord> players;
+};
+
+std::string Encode(const Snapshot& snapshot);
+// Бросает std::runtime_error, если данные повреждены или версия новее известной
+Snapshot Decode(std::string_view data);
+// Начало файла совпадает с MAGIC - двоичный формат, иначе старый текстовый
+bool IsBinary(std::string_view data) noexcept;
+
+}  // namespace data_serializer::snapshot
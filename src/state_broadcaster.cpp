@@ -0,0 +1,105 @@
+#include "state_broadcaster.h"
+
+#include "async_logger.h"
+#include "error_codes.h"
+#include "json_request.h"
+
+namespace api_v1 {
+
+StateBroadcaster::StateBroadcaster(strand_t& strand, app::App& app) : strand_(strand), app_(app) {
+    tick_connection_ = app_.GetMutableGame().session_tick_completed_s.connect(
+        [this](const model::GameSession& session) { OnSessionTick(session); });
+}
+
+void StateBroadcaster::Subscribe(const util::Token& token, const StringRequest& upgrade_request, WebSocketPtr ws) {
+    auto player = app_.GetPlayers().GetPlayerWithCheck(token);
+
+    // Клиент сразу получает текущее состояние, не дожидаясь тика
+    auto state = StateSnapshot(*player->session_).Get(StateFormat::JSON);
+
+    ws->Run(StringRequest(upgrade_request), [this, token, weak = std::weak_ptr(ws)](std::string&& message) {
+        net::dispatch(strand_, [this, token, weak, message = std::move(message)] { OnMessage(token, weak, message); });
+    });
+    ws->Send(std::move(state));
+    subscribers_[player->session_.get()].push_back({token, ws});
+}
+
+void StateBroadcaster::WaitNextTick(std::shared_ptr<model::GameSession> session, Waiter waiter, std::chrono::milliseconds timeout) {
+    auto parked = std::make_shared<ParkedRequest>(ParkedRequest{std::move(waiter), net::steady_timer(strand_, timeout)});
+    parked_[session.get()].push_back(parked);
+
+    parked->timer.async_wait([this, session, weak = std::weak_ptr(parked)](sys::error_code ec) {
+        auto parked = weak.lock();
+        if (ec || !parked || !parked->waiter) 
+            return;
+        auto it = parked_.find(session.get());
+        if (it != parked_.end()) {
+            std::erase(it->second, parked);
+            if (it->second.empty()) 
+                parked_.erase(it);
+        }
+        auto waiter = std::move(parked->waiter);
+        StateSnapshot snapshot(*session);
+        waiter(snapshot);
+    });
+}
+
+void StateBroadcaster::OnSessionTick(const model::GameSession& session) {
+    StateSnapshot snapshot(session);
+
+    // Все запросы, ждавшие тика, получают один и тот же снапшот
+    if (auto it = parked_.find(&session); it != parked_.end()) {
+        auto parked_list = std::move(it->second);
+        parked_.erase(it);
+        for (auto& parked : parked_list) {
+            parked->timer.cancel();
+            if (auto waiter = std::move(parked->waiter)) 
+                waiter(snapshot);
+        }
+    }
+
+    auto it = subscribers_.find(&session);
+    if (it == subscribers_.end()) 
+        return;
+
+    auto& subscribers = it->second;
+    for (auto sub = subscribers.begin(); sub != subscribers.end();) {
+        auto ws = sub->ws.lock();
+        auto player = ws ? app_.GetPlayers().FindByToken(sub->token) : nullptr;
+        if (!player || player->dog_->IsExited()) {
+            if (ws) 
+                ws->Close();
+            sub = subscribers.erase(sub);
+            continue;
+        }
+        ws->Send(snapshot.Get(StateFormat::JSON));
+        ++sub;
+    }
+    if (subscribers.empty()) 
+        subscribers_.erase(it);
+}
+
+void StateBroadcaster::OnMessage(const util::Token& token, const std::weak_ptr<http_server::WebSocketSession>& ws, std::string_view message) {
+    using namespace std::literals;
+    // Формат совпадает с телом POST /api/v1/game/player/action
+    http_handler::ErrorCode error;
+    try {
+        json_loader::RequestFields fields(message);
+        app_.GetPlayers().MovePlayer(token, fields.Get("move"));
+        return;
+    } catch (http_handler::ErrorCode code) {
+        error = code;
+    } catch (const std::exception&) {
+        error = http_handler::ErrorCode::BAD_REQUEST;
+    }
+
+    async_logger::Log(async_logger::Category::NETWORK, async_logger::Level::DEBUG, "websocket command rejected"sv,
+                      {{"code", static_cast<uint32_t>(error)}, {"message", message}});
+    if (auto session = ws.lock()) {
+        StringResponse response;
+        http_handler::FillInfoError(response, error);
+        session->Send(std::make_shared<const std::string>(std::move(response.body())));
+    }
+}
+
+}  // namespace api_v1
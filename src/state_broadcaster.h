@@ -0,0 +1,66 @@
+#pragma once
+
+#include <boost/signals2/connection.hpp>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "app.h"
+#include "headers.h"
+#include "http_server.h"
+#include "state_encoder.h"
+
+namespace api_v1 {
+
+namespace net = boost::asio;
+namespace sys = boost::system;
+
+// Рассылка состояния сессии подписчикам после каждого тика.
+// Состояние кодируется один раз на сессию и раздается всем,
+// работа ведется внутри api strand, запись в сокеты - в их собственных strand
+class StateBroadcaster {
+   public:
+    using WebSocketPtr = std::shared_ptr<http_server::WebSocketSession>;
+    using Waiter = std::function<void(StateSnapshot&)>;
+
+    static constexpr std::chrono::milliseconds LONG_POLL_TIMEOUT{10000};
+
+    StateBroadcaster(strand_t& strand, app::App& app);
+
+    StateBroadcaster(const StateBroadcaster&) = delete;
+    StateBroadcaster& operator=(const StateBroadcaster&) = delete;
+
+    // Вызывать внутри api strand, токен должен быть уже проверен
+    void Subscribe(const util::Token& token, const StringRequest& upgrade_request, WebSocketPtr ws);
+
+    // Long-poll: waiter будет вызван один раз, со снапшотом после следующего тика сессии
+    // или с текущим состоянием по истечении timeout. Вызывать внутри api strand
+    void WaitNextTick(std::shared_ptr<model::GameSession> session, Waiter waiter,
+                      std::chrono::milliseconds timeout = LONG_POLL_TIMEOUT);
+
+   private:
+    struct Subscriber {
+        util::Token token;
+        std::weak_ptr<http_server::WebSocketSession> ws;
+    };
+
+    struct ParkedRequest {
+        Waiter waiter;
+        net::steady_timer timer;
+    };
+    using ParkedRequestPtr = std::shared_ptr<ParkedRequest>;
+
+    void OnSessionTick(const model::GameSession& session);
+    // Ошибочная команда не рвет соединение: клиенту уходит кадр с ошибкой в формате REST API
+    void OnMessage(const util::Token& token, const std::weak_ptr<http_server::WebSocketSession>& ws, std::string_view message);
+
+    strand_t& strand_;
+    app::App& app_;
+    std::unordered_map<const model::GameSession*, std::vector<Subscriber>> subscribers_;
+    std::unordered_map<const model::GameSession*, std::vector<ParkedRequestPtr>> parked_;
+    boost::signals2::scoped_connection tick_connection_;
+};
+
+}  // namespace api_v1
@@ -0,0 +1,186 @@
+#include "state_encoder.h"
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/endian/conversion.hpp>
+#include <cmath>
+#include <cstring>
+
+#include "common.h"
+
+namespace api_v1 {
+
+using namespace std::literals;
+
+namespace {
+
+constexpr std::string_view BINARY_MAGIC = "DST2"sv;
+constexpr size_t BINARY_HEADER_SIZE = 8;
+constexpr size_t BINARY_DOG_SIZE = 32;
+constexpr size_t BINARY_BAG_ITEM_SIZE = 8;
+constexpr size_t BINARY_LOOT_SIZE = 16;
+
+class LittleEndianWriter {
+   public:
+    explicit LittleEndianWriter(std::string& out) : out_(out) {}
+
+    template <typename T>
+    void Put(T value) {
+        boost::endian::native_to_little_inplace(value);
+        out_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void PutFloat(Real value) {
+        float f = static_cast<float>(value);
+        uint32_t bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+        Put(bits);
+    }
+
+   private:
+    std::string& out_;
+};
+
+}  // namespace
+
+StateFormat NegotiateStateFormat(std::string_view accept) {
+    // Учитываются только явно названные типы: */* и application/* не повод отдавать двоичный формат
+    int binary_quality = 0, json_quality = 0;
+    while (auto item = util::NextQualityValue(accept)) {
+        auto [type, quality] = *item;
+        if (boost::algorithm::iequals(type, ContentType::OCTET_STREAM)) 
+            binary_quality = quality;
+        else if (boost::algorithm::iequals(type, ContentType::JSON)) 
+            json_quality = quality;
+    }
+    return binary_quality > 0 && binary_quality >= json_quality ? StateFormat::BINARY : StateFormat::JSON;
+}
+
+std::string_view GetStateContentType(StateFormat format) {
+    return format == StateFormat::BINARY ? ContentType::OCTET_STREAM : ContentType::JSON;
+}
+
+std::string EncodeStateJson(const model::GameSession& session) {
+    const auto& dogs = session.GetDogs();
+    const auto& loot_objects = session.GetLootObjects();
+
+    //Из-за проблем с Json и точностью на тестах пока что про число с плавающей точкой обрабатываются данным образом
+    //В дальнешем найти алтеранативу или совсем убрать округление кординат когда тесты пройдут
+    auto ROUND_VALUE_FOR_TEST = [](double value) -> double {
+        return std::round(value * std::pow(10, 6)) / std::pow(10, 6);
+    };
+
+    auto CreateRoundedNode = [&](boost::property_tree::ptree & node, auto & value) -> boost::property_tree::ptree  {
+
+        if (fmod(value, 1.0) != 0.0) {
+            node.push_back({"", boost::property_tree::ptree().put("", ROUND_VALUE_FOR_TEST(value))});
+        } else {
+            node.push_back({"", boost::property_tree::ptree().put("", std::to_string(int(value)) + "f")});
+        }
+
+        return node;
+    };
+
+    ptree main_json;  // TODO продумать как кастомные json файлы можно применить к системе модели
+    ptree list_dogs_json;
+    for (const auto& dog : dogs) {
+        ptree dog_json;
+
+        boost::property_tree::ptree pos_pt;
+        CreateRoundedNode(pos_pt, dog->GetPosition().x);
+        CreateRoundedNode(pos_pt, dog->GetPosition().y);
+
+        boost::property_tree::ptree speed_pt;
+        CreateRoundedNode(speed_pt, dog->GetSpeed().x);
+        CreateRoundedNode(speed_pt, dog->GetSpeed().y);
+
+        boost::property_tree::ptree bag;
+        for(const auto [id, loot] : dog->GetBag().items) {
+            ptree bag_node;
+            bag_node.put("id", id);
+            bag_node.put("type", loot);
+            bag.push_back({"",bag_node});
+        }
+        if (bag.empty()) 
+            bag.push_back(std::make_pair("", boost::property_tree::ptree()));
+            
+        dog_json.add_child("pos", pos_pt);
+        dog_json.add_child("speed", speed_pt);
+        dog_json.put("dir", dog->GetDirectionChar());
+        dog_json.add_child("bag",bag);
+        dog_json.put("score",dog->GetScore());
+
+        list_dogs_json.add_child(std::to_string(*dog->GetId()) + "S"s, dog_json);
+    }
+    main_json.add_child("players", list_dogs_json);
+
+    ptree objects_list_json;
+    for (const auto& loot_object : loot_objects) {
+        ptree obj_json;
+
+        boost::property_tree::ptree pos_pt;
+        CreateRoundedNode(pos_pt, loot_object->GetPosition().x);
+        CreateRoundedNode(pos_pt, loot_object->GetPosition().y);
+
+        obj_json.put("type", loot_object->GetType());
+        obj_json.add_child("pos", pos_pt);
+        objects_list_json.add_child(std::to_string(loot_object->GetId()) + "S"s, obj_json);
+    }
+    main_json.add_child("lostObjects", objects_list_json);
+
+    return json_loader::JsonObject::GetJson(main_json, false);
+}
+
+std::string EncodeStateBinary(const model::GameSession& session) {
+    const auto& dogs = session.GetDogs();
+    const auto& loot_objects = session.GetLootObjects();
+
+    size_t size = BINARY_HEADER_SIZE + sizeof(uint32_t) + loot_objects.size() * BINARY_LOOT_SIZE;
+    for (const auto& dog : dogs) 
+        size += BINARY_DOG_SIZE + dog->GetBag().items.size() * BINARY_BAG_ITEM_SIZE;
+
+    std::string out;
+    out.reserve(size);
+    out.append(BINARY_MAGIC);
+
+    LittleEndianWriter writer(out);
+    writer.Put(static_cast<uint32_t>(dogs.size()));
+    for (const auto& dog : dogs) {
+        const auto& bag = dog->GetBag().items;
+        writer.Put(static_cast<uint32_t>(*dog->GetId()));
+        writer.PutFloat(dog->GetPosition().x);
+        writer.PutFloat(dog->GetPosition().y);
+        writer.PutFloat(dog->GetSpeed().x);
+        writer.PutFloat(dog->GetSpeed().y);
+        writer.Put(static_cast<uint8_t>(dog->GetDirectionChar()));
+        writer.Put(uint8_t{0});
+        writer.Put(uint16_t{0});
+        writer.Put(static_cast<uint32_t>(dog->GetScore()));
+        writer.Put(static_cast<uint32_t>(bag.size()));
+        for (const auto [id, type] : bag) {
+            writer.Put(static_cast<uint32_t>(id));
+            writer.Put(static_cast<uint32_t>(type));
+        }
+    }
+
+    writer.Put(static_cast<uint32_t>(loot_objects.size()));
+    for (const auto& loot_object : loot_objects) {
+        writer.Put(static_cast<uint32_t>(loot_object->GetId()));
+        writer.Put(static_cast<uint32_t>(loot_object->GetType()));
+        writer.PutFloat(loot_object->GetPosition().x);
+        writer.PutFloat(loot_object->GetPosition().y);
+    }
+    return out;
+}
+
+std::string EncodeState(const model::GameSession& session, StateFormat format) {
+    return format == StateFormat::BINARY ? EncodeStateBinary(session) : EncodeStateJson(session);
+}
+
+StateSnapshot::StatePtr StateSnapshot::Get(StateFormat format) {
+    auto& state = format == StateFormat::BINARY ? binary_ : json_;
+    if (!state) 
+        state = std::make_shared<const std::string>(EncodeState(session_, format));
+    return state;
+}
+
+}  // namespace api_v1
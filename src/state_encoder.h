@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "model.h"
+
+// Кодирование состояния игровой сессии для отдачи клиентам.
+// Состояние общее для всех игроков сессии, поэтому его можно кодировать
+// один раз и раздавать всем подписчикам
+namespace api_v1 {
+
+enum class StateFormat { JSON, BINARY };
+
+// JSON по умолчанию, бинарный формат только если клиент явно запросил application/octet-stream
+// с q > 0 и не ниже, чем у application/json
+StateFormat NegotiateStateFormat(std::string_view accept);
+std::string_view GetStateContentType(StateFormat format);
+
+std::string EncodeStateJson(const model::GameSession& session);
+
+/*
+    Бинарное состояние, все числа little-endian, float - IEEE754 32 бит
+    header:  char[4] "DST2", u32 dogs_count
+    dog:     u32 id, f32 pos_x, f32 pos_y, f32 speed_x, f32 speed_y,
+             u8 dir ('U','R','D','L'), u8 reserved, u16 reserved, u32 score, u32 bag_count,
+             bag_count * { u32 loot_id, u32 loot_type }
+    then:    u32 loots_count
+    loot:    u32 id, u32 type, f32 pos_x, f32 pos_y
+*/
+std::string EncodeStateBinary(const model::GameSession& session);
+
+std::string EncodeState(const model::GameSession& session, StateFormat format);
+
+// Снапшот одного состояния сессии, каждый формат кодируется не более одного раза
+class StateSnapshot {
+   public:
+    using StatePtr = std::shared_ptr<const std::string>;
+
+    explicit StateSnapshot(const model::GameSession& session) : session_(session) {}
+
+    StatePtr Get(StateFormat format);
+
+   private:
+    const model::GameSession& session_;
+    StatePtr json_;
+    StatePtr binary_;
+};
+
+}  // namespace api_v1
@@ -0,0 +1,144 @@
+#include "static_cache.h"
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#include "common.h"
+
+namespace {
+namespace http = boost::beast::http;
+namespace fs = std::filesystem;
+
+std::string MakeEtag(const std::string& data) {
+    // FNV-1a, ETag должен только меняться вместе с содержимым
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+    }
+    char buffer[24];
+    std::snprintf(buffer, sizeof(buffer), "\"%016llx\"", static_cast<unsigned long long>(hash));
+    return buffer;
+}
+
+// IMF-fixdate (RFC 7231): "Sun, 06 Nov 1994 08:49:37 GMT"
+std::string MakeHttpDate(fs::file_time_type file_time) {
+    static constexpr const char* days[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    static constexpr const char* months[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+    auto sys_time = std::chrono::file_clock::to_sys(file_time);
+    std::time_t time = std::chrono::system_clock::to_time_t(std::chrono::time_point_cast<std::chrono::system_clock::duration>(sys_time));
+    std::tm tm{};
+    gmtime_r(&time, &tm);
+
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%s, %02d %s %04d %02d:%02d:%02d GMT", days[tm.tm_wday], tm.tm_mday, months[tm.tm_mon],
+                  tm.tm_year + 1900, tm.tm_hour, tm.tm_min, tm.tm_sec);
+    return buffer;
+}
+
+// Разные кодировки - разные представления, у каждого свой ETag
+std::string MakeEncodedEtag(const std::string& etag, compression::Encoding encoding) {
+    return etag.substr(0, etag.size() - 1) + "-"s + std::string(compression::GetEncodingName(encoding)) + "\""s;
+}
+
+bool IsNotModified(const http_handler::StaticCache::Entry& entry, const std::string& etag, const StringRequest& req) {
+    // If-None-Match важнее If-Modified-Since (RFC 7232, 6)
+    auto if_none_match = util::ToSV(req[http::field::if_none_match]);
+    if (!if_none_match.empty())
+        return if_none_match == "*"sv || if_none_match.find(etag) != std::string_view::npos;
+
+    // Браузеры возвращают Last-Modified без изменений, поэтому разбор даты не нужен
+    auto if_modified_since = util::ToSV(req[http::field::if_modified_since]);
+    return !if_modified_since.empty() && if_modified_since == entry.last_modified;
+}
+
+}  // namespace
+
+namespace http_handler {
+
+StaticCache::StaticCache(std::string_view root) : root_(root) { Reload(); }
+
+void StaticCache::Reload() {
+    entries_.clear();
+    std::error_code ec;
+    if (root_.empty() || !fs::is_directory(root_, ec))
+        return;
+
+    fs::path root(root_);
+    for (auto it = fs::recursive_directory_iterator(root, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        if (!it->is_regular_file(ec) || it->file_size(ec) > MAX_FILE_SIZE)
+            continue;
+
+        std::ifstream in(it->path(), std::ios::binary);
+        if (!in)
+            continue;
+        std::string data{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+
+        Entry entry;
+        entry.content_type = util::GetMimeContentType(it->path().extension().string());
+        entry.last_modified = MakeHttpDate(it->last_write_time(ec));
+
+        auto etag = MakeEtag(data);
+        if (compression::IsCompressibleContentType(entry.content_type)) {
+            for (auto encoding : {compression::Encoding::GZIP, compression::Encoding::DEFLATE}) {
+                auto compressed = compression::Compress(data, encoding, compression::STATIC_LEVEL);
+                if (compressed.size() < data.size())
+                    entry.representations[static_cast<size_t>(encoding)] = {std::make_shared<const std::string>(std::move(compressed)),
+                                                                            MakeEncodedEtag(etag, encoding)};
+            }
+        }
+        entry.representations[static_cast<size_t>(compression::Encoding::IDENTITY)] = {std::make_shared<const std::string>(std::move(data)),
+                                                                                       std::move(etag)};
+
+        entries_.emplace("/"s + it->path().lexically_relative(root).generic_string(), std::move(entry));
+    }
+}
+
+const StaticCache::Entry* StaticCache::Find(std::string_view path) const {
+    auto it = entries_.find(path);
+    return it == entries_.end() ? nullptr : &it->second;
+}
+
+const StaticCache::Representation& StaticCache::Entry::Get(compression::Encoding encoding) const {
+    const auto& representation = representations[static_cast<size_t>(encoding)];
+    return representation.data ? representation : representations[static_cast<size_t>(compression::Encoding::IDENTITY)];
+}
+
+bool StaticCache::Entry::IsCompressible() const {
+    return Get(compression::Encoding::GZIP).data != Raw().data || Get(compression::Encoding::DEFLATE).data != Raw().data;
+}
+
+CachedResponse StaticCache::MakeResponse(const Entry& entry, const StringRequest& req) {
+    auto encoding = compression::NegotiateEncoding(util::ToSV(req[http::field::accept_encoding]));
+    const auto& representation = entry.Get(encoding);
+
+    CachedResponse res;
+    res.version(req.version());
+    res.keep_alive(req.keep_alive());
+    res.set(http::field::content_type, entry.content_type);
+    res.set(http::field::etag, representation.etag);
+    res.set(http::field::last_modified, entry.last_modified);
+    if (entry.IsCompressible())
+        res.set(http::field::vary, "Accept-Encoding");
+
+    if (IsNotModified(entry, representation.etag, req)) {
+        res.result(http::status::not_modified);
+        return res;
+    }
+
+    if (representation.data != entry.Raw().data)
+        res.set(http::field::content_encoding, util::ToBSV(compression::GetEncodingName(encoding)));
+
+    res.result(http::status::ok);
+    res.content_length(representation.data->size());
+    if (req.method() != http::verb::head)
+        res.body() = representation.data;
+    return res;
+}
+
+}  // namespace http_handler
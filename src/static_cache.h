@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "compression.h"
+#include "headers.h"
+
+namespace http_handler {
+
+// Содержимое www-root, прочитанное в память при старте.
+// Заголовки ответа считаются один раз, поэтому попадание в кеш не трогает файловую систему.
+// После построения кеш только читается, его можно использовать из любого потока
+class StaticCache {
+   public:
+    // Файлы крупнее отдаются с диска
+    static constexpr uintmax_t MAX_FILE_SIZE = 4 * 1024 * 1024;
+
+    struct Representation {
+        std::shared_ptr<const std::string> data;
+        std::string etag;
+    };
+
+    struct Entry {
+        // Индекс - compression::Encoding. Сжатые варианты строятся при загрузке,
+        // пустой data - сжатие не дало выигрыша или тип не сжимается
+        std::array<Representation, 3> representations;
+        std::string content_type;
+        std::string last_modified;
+
+        const Representation& Get(compression::Encoding encoding) const;
+        const Representation& Raw() const { return Get(compression::Encoding::IDENTITY); }
+        bool IsCompressible() const;
+    };
+
+    explicit StaticCache(std::string_view root);
+
+    // Полностью перечитать каталог. Не потокобезопасно, только до запуска сервера
+    void Reload();
+
+    // path вида "/js/three.js", уже декодированный. nullptr если файла нет в кеше
+    const Entry* Find(std::string_view path) const;
+    size_t size() const noexcept { return entries_.size(); }
+
+    // 200 с телом из кеша (сжатым, если клиент согласен) или 304, если у клиента актуальная копия
+    static CachedResponse MakeResponse(const Entry& entry, const StringRequest& req);
+
+   private:
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view sv) const { return std::hash<std::string_view>{}(sv); }
+    };
+
+    std::string root_;
+    std::unordered_map<std::string, Entry, StringHash, std::equal_to<>> entries_;
+};
+
+}  // namespace http_handler
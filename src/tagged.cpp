@@ -1,12 +1,7 @@
 #include "tagged.h"
 
-#include <boost/algorithm/string.hpp>
-#include <boost/lexical_cast.hpp>
-#include <boost/uuid/uuid.hpp>
-#include <boost/uuid/uuid_generators.hpp>
-#include <boost/uuid/uuid_io.hpp>
-
 #include "error_codes.h"
+#include "token_minter.h"
 
 namespace {
 using namespace std::literals;
@@ -15,20 +10,63 @@ using ec = http_handler::ErrorCode;
 
 namespace util {
 
-Token GenerateRandomToken() {
-    auto uuid = boost::uuids::random_generator()();
-    auto uuid_without_space = boost::lexical_cast<std::string>(uuid);
-    uuid_without_space.erase(std::remove_if(uuid_without_space.begin(), uuid_without_space.end(), [](char c) { return c == '-'; }),
-                             uuid_without_space.end());
-    return Token(uuid_without_space);
+namespace {
+
+int HexDigit(char c) noexcept {
+    if (c >= '0' && c <= '9') 
+        return c - '0';
+    if (c >= 'a' && c <= 'f') 
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') 
+        return c - 'A' + 10;
+    return -1;
+}
+
+bool ParseHalf(std::string_view hex, uint64_t& out) noexcept {
+    out = 0;
+    for (char c : hex) {
+        int digit = HexDigit(c);
+        if (digit < 0) 
+            return false;
+        out = (out << 4) | static_cast<uint64_t>(digit);
+    }
+    return true;
+}
+
+void WriteHalf(uint64_t value, char* out) noexcept {
+    static constexpr char digits[] = "0123456789abcdef";
+    for (int i = 15; i >= 0; --i, value >>= 4) 
+        out[i] = digits[value & 0xf];
 }
 
+}  // namespace
+
+Token GenerateRandomToken() { return TokenMinter::ThreadLocal().Mint(); }
+
 Token CreateTokenByAuthorizationString(std::string_view token_raw) noexcept(false) {
     if (token_raw.substr(0, 7) == "Bearer "sv) 
         token_raw.remove_prefix(7);
-    if (token_raw.size() != util::TOKEN_SIZE) 
+    if (token_raw.size() != TOKEN_SIZE) 
         throw ec::AUTHORIZATION_NOT_EXIST;
-    return Token{std::string(token_raw.data(), token_raw.size())};
+    // Токен правильной длины, но не hex, раньше просто не находился среди игроков
+    auto token = ParseTokenHex(token_raw);
+    if (!token) 
+        throw ec::AUTHORIZATION_NOT_FOUND;
+    return *token;
+}
+
+std::optional<Token> ParseTokenHex(std::string_view hex) noexcept {
+    if (hex.size() != TOKEN_SIZE) 
+        return std::nullopt;
+    TokenBits bits;
+    if (!ParseHalf(hex.substr(0, TOKEN_SIZE / 2), bits.hi) || !ParseHalf(hex.substr(TOKEN_SIZE / 2), bits.lo)) 
+        return std::nullopt;
+    return Token(bits);
+}
+
+void TokenToHex(const Token& token, std::array<char, TOKEN_SIZE>& hex) noexcept {
+    WriteHalf((*token).hi, hex.data());
+    WriteHalf((*token).lo, hex.data() + TOKEN_SIZE / 2);
 }
 
 }  // namespace util
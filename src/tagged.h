@@ -1,6 +1,11 @@
 #pragma once
+#include <array>
 #include <compare>
+#include <cstdint>
+#include <optional>
 #include <random>
+#include <string>
+#include <string_view>
 
 namespace util {
 
@@ -49,12 +54,26 @@ class Tagged {
 
 // namespace detail
 struct TokenTag {};
-using Token = Tagged<std::string, TokenTag>;
+
+// 128 бит токена, снаружи передается как 32 hex-символа
+struct TokenBits {
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+
+    auto operator<=>(const TokenBits&) const = default;
+};
+
+using Token = Tagged<TokenBits, TokenTag>;
 constexpr size_t TOKEN_SIZE = 32;
 
 Token GenerateRandomToken();
+// Разбирает заголовок Authorization ("Bearer <hex>") сразу в двоичный вид
 Token CreateTokenByAuthorizationString(std::string_view token_raw) noexcept(false);
 
+std::optional<Token> ParseTokenHex(std::string_view hex) noexcept;
+// 32 hex-символа в буфер вызывающего, без выделения памяти
+void TokenToHex(const Token& token, std::array<char, TOKEN_SIZE>& hex) noexcept;
+
 // Хешер для Tagged-типа, чтобы Tagged-объекты можно было хранить в unordered-контейнерах
 template <typename TaggedValue>
 struct TaggedHasher {
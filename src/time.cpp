@@ -1,12 +1,25 @@
 #include "time.h"
 
+#include "metrics.h"
+
 void model::TimeManager::GlobalTick(const std::chrono::milliseconds& ms) {
+    // Фаза тика - группа подписчиков с одним приоритетом: 20 - собаки, 10 - сессии, 0 - сохранение
+    auto phase_start = metrics::Histogram::Clock::now();
+    auto finish_phase = [&phase_start](int priority) {
+        auto now = metrics::Histogram::Clock::now();
+        metrics::TickDuration().WithLabels({std::to_string(priority)}).Observe(now - phase_start);
+        phase_start = now;
+    };
+
     for (auto it = subscribers_.begin(); it != subscribers_.end();) {
+        auto priority = it->first;
         if (auto timeObjPtr = it->second.lock()) {
             timeObjPtr->Tick(ms);
             ++it;
         } else 
             it = subscribers_.erase(it);
+        if (it == subscribers_.end() || it->first != priority) 
+            finish_phase(priority);
     }
 }
 
@@ -0,0 +1,135 @@
+#include "token_minter.h"
+
+#include <algorithm>
+#include <random>
+
+namespace {
+
+constexpr uint32_t Rotl(uint32_t value, int shift) { return (value << shift) | (value >> (32 - shift)); }
+
+inline void QuarterRound(uint32_t& a, uint32_t& b, uint32_t& c, uint32_t& d) {
+    a += b; d ^= a; d = Rotl(d, 16);
+    c += d; b ^= c; b = Rotl(b, 12);
+    a += b; d ^= a; d = Rotl(d, 8);
+    c += d; b ^= c; b = Rotl(b, 7);
+}
+
+// "expand 32-byte k"
+constexpr uint32_t SIGMA[4] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+
+}  // namespace
+
+namespace util {
+
+ChaCha20Rng::ChaCha20Rng() {
+    std::random_device device;
+    Key key;
+    for (auto& word : key)
+        word = device();
+    uint64_t nonce = (uint64_t(device()) << 32) | device();
+    *this = ChaCha20Rng(key, 0, nonce);
+}
+
+ChaCha20Rng::ChaCha20Rng(const Key& key, uint64_t counter, uint64_t nonce) {
+    for (size_t i = 0; i < 4; ++i)
+        state_[i] = SIGMA[i];
+    for (size_t i = 0; i < key.size(); ++i)
+        state_[4 + i] = key[i];
+    state_[12] = static_cast<uint32_t>(counter);
+    state_[13] = static_cast<uint32_t>(counter >> 32);
+    state_[14] = static_cast<uint32_t>(nonce);
+    state_[15] = static_cast<uint32_t>(nonce >> 32);
+}
+
+void ChaCha20Rng::NextBlock() {
+    auto x = state_;
+    for (int i = 0; i < 10; ++i) {
+        QuarterRound(x[0], x[4], x[8], x[12]);
+        QuarterRound(x[1], x[5], x[9], x[13]);
+        QuarterRound(x[2], x[6], x[10], x[14]);
+        QuarterRound(x[3], x[7], x[11], x[15]);
+        QuarterRound(x[0], x[5], x[10], x[15]);
+        QuarterRound(x[1], x[6], x[11], x[12]);
+        QuarterRound(x[2], x[7], x[8], x[13]);
+        QuarterRound(x[3], x[4], x[9], x[14]);
+    }
+    for (size_t i = 0; i < x.size(); ++i) {
+        uint32_t word = x[i] + state_[i];
+        block_[i * 4] = static_cast<uint8_t>(word);
+        block_[i * 4 + 1] = static_cast<uint8_t>(word >> 8);
+        block_[i * 4 + 2] = static_cast<uint8_t>(word >> 16);
+        block_[i * 4 + 3] = static_cast<uint8_t>(word >> 24);
+    }
+    if (++state_[12] == 0)
+        ++state_[13];
+    block_pos_ = 0;
+}
+
+void ChaCha20Rng::Fill(uint8_t* out, size_t size) {
+    while (size > 0) {
+        if (block_pos_ == BLOCK_SIZE)
+            NextBlock();
+        size_t chunk = std::min(size, BLOCK_SIZE - block_pos_);
+        std::copy_n(block_.data() + block_pos_, chunk, out);
+        block_pos_ += chunk;
+        out += chunk;
+        size -= chunk;
+    }
+}
+
+uint64_t ChaCha20Rng::NextU64() {
+    uint8_t bytes[8];
+    Fill(bytes, sizeof(bytes));
+    uint64_t value = 0;
+    for (auto byte : bytes)
+        value = (value << 8) | byte;
+    return value;
+}
+
+TokenMinter& TokenMinter::ThreadLocal() {
+    thread_local TokenMinter minter;
+    return minter;
+}
+
+void TokenMinter::Prefetch() {
+    uint8_t bytes[BATCH_SIZE * 16];
+    rng_.Fill(bytes, sizeof(bytes));
+    for (size_t i = 0; i < BATCH_SIZE; ++i) {
+        TokenBits bits;
+        for (size_t j = 0; j < 8; ++j) {
+            bits.hi = (bits.hi << 8) | bytes[i * 16 + j];
+            bits.lo = (bits.lo << 8) | bytes[i * 16 + 8 + j];
+        }
+        batch_[i] = bits;
+    }
+    batch_pos_ = 0;
+}
+
+Token TokenMinter::Mint() {
+    if (batch_pos_ == BATCH_SIZE)
+        Prefetch();
+    return Token(batch_[batch_pos_++]);
+}
+
+std::string TokenMinter::MintUuid() {
+    auto token = Mint();
+    auto& bits = *token;
+    bits.hi = (bits.hi & ~0xf000ull) | 0x4000ull;                    // версия 4
+    bits.lo = (bits.lo & ~(0xc0ull << 56)) | (0x80ull << 56);        // вариант RFC 4122
+
+    std::array<char, TOKEN_SIZE> buffer;
+    TokenToHex(token, buffer);
+    std::string_view hex(buffer.data(), buffer.size());
+    std::string uuid;
+    uuid.reserve(TOKEN_SIZE + 4);
+    uuid.append(hex.substr(0, 8)).append(1, '-');
+    uuid.append(hex.substr(8, 4)).append(1, '-');
+    uuid.append(hex.substr(12, 4)).append(1, '-');
+    uuid.append(hex.substr(16, 4)).append(1, '-');
+    uuid.append(hex.substr(20, 12));
+    return uuid;
+}
+
+std::string GenerateRandomUuid() { return TokenMinter::ThreadLocal().MintUuid(); }
+
+}  // namespace util
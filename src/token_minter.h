@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "tagged.h"
+
+////////////////////////////////////////////////
+//// Криптостойкая генерация токенов и UUID
+////////////////////////////////////////////////
+
+namespace util {
+
+// ChaCha20 (RFC 8439) как генератор потока случайных байт.
+// Ключ берется из системного источника энтропии один раз при создании
+class ChaCha20Rng {
+   public:
+    static constexpr size_t BLOCK_SIZE = 64;
+    using Key = std::array<uint32_t, 8>;
+
+    ChaCha20Rng();
+    ChaCha20Rng(const Key& key, uint64_t counter, uint64_t nonce);
+
+    void Fill(uint8_t* out, size_t size);
+    uint64_t NextU64();
+
+   private:
+    void NextBlock();
+
+    std::array<uint32_t, 16> state_;
+    std::array<uint8_t, BLOCK_SIZE> block_;
+    size_t block_pos_ = BLOCK_SIZE;
+};
+
+// Выдает токены из заранее сгенерированной пачки, свой экземпляр на каждый поток,
+// поэтому синхронизация не нужна
+class TokenMinter {
+   public:
+    static constexpr size_t BATCH_SIZE = 64;
+
+    static TokenMinter& ThreadLocal();
+
+    Token Mint();
+    // Заполнить пачку заранее, например перед стартом раунда
+    void Prefetch();
+
+    // UUID v4 в текстовом виде "xxxxxxxx-xxxx-4xxx-yxxx-xxxxxxxxxxxx"
+    std::string MintUuid();
+
+   private:
+    ChaCha20Rng rng_;
+    std::array<TokenBits, BATCH_SIZE> batch_;
+    size_t batch_pos_ = BATCH_SIZE;
+};
+
+std::string GenerateRandomUuid();
+
+}  // namespace util
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "tagged.h"
+
+namespace util {
+
+// Плоская хеш-таблица с открытой адресацией (линейное пробирование) по двоичному токену.
+// Удаление сдвигает хвост цепочки назад, поэтому надгробий нет и поиск не деградирует
+template <typename Value>
+class TokenTable {
+   public:
+    using Entry = std::pair<Token, Value>;
+
+    class const_iterator {
+       public:
+        const_iterator(const std::vector<std::optional<Entry>>* slots, size_t index) : slots_(slots), index_(index) { SkipEmpty(); }
+
+        const Entry& operator*() const { return *(*slots_)[index_]; }
+        const Entry* operator->() const { return &*(*slots_)[index_]; }
+
+        const_iterator& operator++() {
+            ++index_;
+            SkipEmpty();
+            return *this;
+        }
+
+        bool operator==(const const_iterator& other) const { return index_ == other.index_; }
+        bool operator!=(const const_iterator& other) const { return index_ != other.index_; }
+
+       private:
+        void SkipEmpty() {
+            while (index_ < slots_->size() && !(*slots_)[index_])
+                ++index_;
+        }
+
+        const std::vector<std::optional<Entry>>* slots_;
+        size_t index_;
+    };
+
+    TokenTable() : slots_(MIN_CAPACITY), shift_(64 - MIN_CAPACITY_BITS) {}
+
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    const_iterator begin() const { return const_iterator(&slots_, 0); }
+    const_iterator end() const { return const_iterator(&slots_, slots_.size()); }
+
+    Value* Find(const Token& token) noexcept {
+        auto index = FindIndex(token);
+        return index == NONE ? nullptr : &slots_[index]->second;
+    }
+    const Value* Find(const Token& token) const noexcept {
+        auto index = FindIndex(token);
+        return index == NONE ? nullptr : &slots_[index]->second;
+    }
+
+    // Вставка или замена значения
+    Value& Insert(const Token& token, Value value) {
+        if (auto index = FindIndex(token); index != NONE) {
+            slots_[index]->second = std::move(value);
+            return slots_[index]->second;
+        }
+        if ((size_ + 1) * 4 > slots_.size() * 3)
+            Rehash(slots_.size() * 2);
+        ++size_;
+        return PlaceNew(Entry(token, std::move(value)));
+    }
+
+    bool Erase(const Token& token) noexcept {
+        auto hole = FindIndex(token);
+        if (hole == NONE)
+            return false;
+
+        const size_t mask = slots_.size() - 1;
+        slots_[hole].reset();
+        --size_;
+        for (size_t i = (hole + 1) & mask;; i = (i + 1) & mask) {
+            if (!slots_[i])
+                break;
+            size_t home = HomeIndex(slots_[i]->first);
+            // Элемент можно сдвинуть в дыру, если она лежит между его домашней ячейкой и текущей
+            if (((i - home) & mask) >= ((i - hole) & mask)) {
+                slots_[hole] = std::move(slots_[i]);
+                slots_[i].reset();
+                hole = i;
+            }
+        }
+        return true;
+    }
+
+    void Clear() noexcept {
+        for (auto& slot : slots_)
+            slot.reset();
+        size_ = 0;
+    }
+
+   private:
+    static constexpr size_t NONE = ~size_t(0);
+    static constexpr unsigned MIN_CAPACITY_BITS = 4;
+    static constexpr size_t MIN_CAPACITY = size_t(1) << MIN_CAPACITY_BITS;
+
+    size_t HomeIndex(const Token& token) const noexcept {
+        // Токены случайны, но после загрузки сохранения могут прийти откуда угодно - перемешиваем
+        uint64_t hash = ((*token).hi ^ (*token).lo) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(hash >> shift_);
+    }
+
+    size_t FindIndex(const Token& token) const noexcept {
+        const size_t mask = slots_.size() - 1;
+        for (size_t i = HomeIndex(token); slots_[i]; i = (i + 1) & mask) {
+            if (slots_[i]->first == token)
+                return i;
+        }
+        return NONE;
+    }
+
+    Value& PlaceNew(Entry&& entry) {
+        const size_t mask = slots_.size() - 1;
+        size_t i = HomeIndex(entry.first);
+        while (slots_[i])
+            i = (i + 1) & mask;
+        slots_[i].emplace(std::move(entry));
+        return slots_[i]->second;
+    }
+
+    void Rehash(size_t capacity) {
+        auto old = std::exchange(slots_, std::vector<std::optional<Entry>>(capacity));
+        shift_ = 64;
+        for (size_t c = capacity; c > 1; c >>= 1)
+            --shift_;
+        for (auto& slot : old) {
+            if (slot)
+                PlaceNew(std::move(*slot));
+        }
+    }
+
+    std::vector<std::optional<Entry>> slots_;
+    unsigned shift_;
+    size_t size_ = 0;
+};
+
+}  // namespace util
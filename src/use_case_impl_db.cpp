@@ -6,17 +6,35 @@ namespace app {
 
 void UseCasesImpl::AddPlayerRetired(const RetiredPlayerInfo& player) {
     postgres::RetiredPlayerRepositoryImpl players_rep(database_.GetConnection());
-    players_rep.AddRetriedPlayer(domain::RetiredPlayer(player.name_, player.score_, player.play_time_ms_));
+    players_rep.AddRetriedPlayer(domain::RetiredPlayer(player.name_, player.score_, player.play_time_ms_,
+                                                       player.id_.empty() ? std::nullopt : std::optional(player.id_)));
 }
 
-UseCases::players_list_t UseCasesImpl::GetPlayersRetired(int offset, int limit) { 
-    postgres::RetiredPlayerRepositoryImpl players_rep(database_.GetConnection());
-    auto players_list = players_rep.GetSortedRetiredPlayersList(offset, limit);
+namespace {
+
+// Курсор без id стоит перед всеми записями с тем же ключом
+constexpr const char NIL_UUID[] = "00000000-0000-0000-0000-000000000000";
+
+UseCases::players_list_t ToPlayersList(const domain::RetiredPlayerRepository::retired_players_t & players_list) {
     UseCases::players_list_t list;
-    std:;transform(players_list.begin(), players_list.end(), std::back_inserter(list), [](const domain::RetiredPlayer & player) -> RetiredPlayerInfo {
-        return {player.GetName() , player.GetScore(), player.GetPlayTimeMs()};
+    list.reserve(players_list.size());
+    std::transform(players_list.begin(), players_list.end(), std::back_inserter(list), [](const domain::RetiredPlayer & player) -> RetiredPlayerInfo {
+        return {player.GetName() , player.GetScore(), player.GetPlayTimeMs(), player.GetId()};
     });
     return list;
 }
 
+}  // namespace
+
+UseCases::players_list_t UseCasesImpl::GetPlayersRetired(int offset, int limit) { 
+    postgres::RetiredPlayerRepositoryImpl players_rep(database_.GetConnection());
+    return ToPlayersList(players_rep.GetSortedRetiredPlayersList(offset, limit));
+}
+
+UseCases::players_list_t UseCasesImpl::GetPlayersRetiredAfter(const RetiredPlayerInfo & after, int limit) { 
+    postgres::RetiredPlayerRepositoryImpl players_rep(database_.GetConnection());
+    return ToPlayersList(players_rep.GetSortedRetiredPlayersAfter(after.score_, after.play_time_ms_, after.name_,
+                                                                  after.id_.empty() ? NIL_UUID : after.id_, limit));
+}
+
 }
\ No newline at end of file
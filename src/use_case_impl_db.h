@@ -12,6 +12,7 @@ public:
 
     void AddPlayerRetired(const RetiredPlayerInfo & player) override;
     players_list_t GetPlayersRetired(int offset, int limit) override;
+    players_list_t GetPlayersRetiredAfter(const RetiredPlayerInfo & after, int limit) override;
 
 private:
     postgres::Database & database_;
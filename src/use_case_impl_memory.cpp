@@ -0,0 +1,139 @@
+#include "use_case_impl_memory.h"
+
+#include <iterator>
+#include <stdexcept>
+
+#include "async_logger.h"
+#include "token_minter.h"
+
+namespace app {
+
+UseCasesMemory::UseCasesMemory(const std::filesystem::path & file) {
+    if (file.empty()) 
+        return;
+
+    size_t skipped = 0;
+    bool torn = false;
+    // Размер файла без оборванной последней строки
+    std::uintmax_t complete_size = 0;
+    if (std::ifstream in{file, std::ios::binary}) {
+        std::string line;
+        while (std::getline(in, line)) {
+            // Строка без '\n' записана не до конца, даже если разбирается: имя могло оборваться
+            if (in.eof()) {
+                torn = true;
+                ++skipped;
+                break;
+            }
+            complete_size += line.size() + 1;
+            if (auto player = DecodeLine(line)) {
+                // Строки, записанные до появления id, получают новый
+                if (player->id_.empty()) 
+                    player->id_ = util::GenerateRandomUuid();
+                players_.insert(std::move(*player));
+            } else {
+                ++skipped;
+            }
+        }
+    }
+    // Оборванная последняя строка после аварийного завершения не мешает запуску
+    if (skipped) 
+        async_logger::Log("records file lines skipped", {{"file", file.string()}, {"count", skipped}});
+    // Отрезается, чтобы новые записи не склеились с ней и она не ожила при следующем запуске
+    if (torn) 
+        std::filesystem::resize_file(file, complete_size);
+
+    file_.open(file, std::ios::app | std::ios::binary);
+    if (!file_) 
+        throw std::runtime_error("Can't open records file " + file.string());
+}
+
+void UseCasesMemory::AddPlayerRetired(const RetiredPlayerInfo & player) {
+    auto record = player;
+    if (record.id_.empty()) 
+        record.id_ = util::GenerateRandomUuid();
+    std::unique_lock lock(mutex_);
+    auto it = players_.insert(std::move(record));
+    if (file_.is_open()) {
+        file_ << EncodeLine(*it) << '\n';
+        file_.flush();
+    }
+}
+
+UseCases::players_list_t UseCasesMemory::GetPlayersRetired(int offset, int limit) {
+    std::shared_lock lock(mutex_);
+    players_list_t list;
+    if (offset < 0 || static_cast<size_t>(offset) >= players_.size()) 
+        return list;
+    auto it = std::next(players_.begin(), offset);
+    for (; it != players_.end() && list.size() < static_cast<size_t>(limit); ++it) 
+        list.push_back(*it);
+    return list;
+}
+
+UseCases::players_list_t UseCasesMemory::GetPlayersRetiredAfter(const RetiredPlayerInfo & after, int limit) {
+    std::shared_lock lock(mutex_);
+    players_list_t list;
+    for (auto it = players_.upper_bound(after); it != players_.end() && list.size() < static_cast<size_t>(limit); ++it) 
+        list.push_back(*it);
+    return list;
+}
+
+size_t UseCasesMemory::Size() const {
+    std::shared_lock lock(mutex_);
+    return players_.size();
+}
+
+std::string UseCasesMemory::EncodeLine(const RetiredPlayerInfo & player) {
+    auto line = std::to_string(player.score_) + '\t' + std::to_string(player.play_time_ms_) + '\t' + player.id_ + '\t';
+    for (char c : player.name_) {
+        if (c == '\\') 
+            line += "\\\\";
+        else if (c == '\t') 
+            line += "\\t";
+        else if (c == '\n') 
+            line += "\\n";
+        else 
+            line += c;
+    }
+    return line;
+}
+
+std::optional<RetiredPlayerInfo> UseCasesMemory::DecodeLine(std::string_view line) {
+    auto first = line.find('\t');
+    auto second = first == std::string_view::npos ? first : line.find('\t', first + 1);
+    if (second == std::string_view::npos) 
+        return std::nullopt;
+    auto score = ParseRecordInt(line.substr(0, first));
+    auto play_time = ParseRecordInt(line.substr(first + 1, second - first - 1));
+    if (!score || !play_time) 
+        return std::nullopt;
+    // В строках до появления id после времени сразу идет имя. В имени табуляция экранирована
+    std::string id;
+    auto name_begin = second + 1;
+    if (auto third = line.find('\t', second + 1); third != std::string_view::npos) {
+        id = line.substr(second + 1, third - second - 1);
+        name_begin = third + 1;
+    }
+
+    std::string name;
+    for (size_t i = name_begin; i < line.size(); ++i) {
+        if (line[i] != '\\') {
+            if (line[i] == '\t') 
+                return std::nullopt;
+            name += line[i];
+            continue;
+        }
+        if (++i == line.size()) 
+            return std::nullopt;
+        switch (line[i]) {
+            case '\\': name += '\\'; break;
+            case 't': name += '\t'; break;
+            case 'n': name += '\n'; break;
+            default: return std::nullopt;
+        }
+    }
+    return RetiredPlayerInfo{std::move(name), *score, *play_time, std::move(id)};
+}
+
+}  // namespace app
@@ -0,0 +1,35 @@
+#pragma once
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <set>
+#include <shared_mutex>
+
+#include "use_cases.h"
+
+namespace app {
+
+// Таблица рекордов в памяти процесса, для запуска без Postgres (нагрузочные тесты, CI).
+// Порядок тот же, что у запроса к БД: очки по убыванию, затем время игры, имя и id записи.
+// Если задан файл, каждая запись дописывается в его конец и читается обратно при старте
+class UseCasesMemory : public UseCases {
+public:
+    explicit UseCasesMemory(const std::filesystem::path & file = {});
+
+    void AddPlayerRetired(const RetiredPlayerInfo & player) override;
+    players_list_t GetPlayersRetired(int offset, int limit) override;
+    players_list_t GetPlayersRetiredAfter(const RetiredPlayerInfo & after, int limit) override;
+
+    size_t Size() const;
+
+    // Строка файла: очки, время игры, id и имя через табуляцию. \t, \n и \ в имени экранируются
+    static std::string EncodeLine(const RetiredPlayerInfo & player);
+    static std::optional<RetiredPlayerInfo> DecodeLine(std::string_view line);
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::multiset<RetiredPlayerInfo, RecordsLess> players_;
+    std::ofstream file_;
+};
+
+}  // namespace app
@@ -0,0 +1,20 @@
+#include "use_cases.h"
+
+#include <charconv>
+#include <tuple>
+
+namespace app {
+
+bool RecordsLess::operator()(const RetiredPlayerInfo & lhs, const RetiredPlayerInfo & rhs) const {
+    return std::tie(rhs.score_, lhs.play_time_ms_, lhs.name_, lhs.id_) < std::tie(lhs.score_, rhs.play_time_ms_, rhs.name_, rhs.id_);
+}
+
+std::optional<int> ParseRecordInt(std::string_view text) {
+    int value = 0;
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc() || end != text.data() + text.size() || text.empty()) 
+        return std::nullopt;
+    return value;
+}
+
+}  // namespace app
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
 #include <optional>
 
 namespace app {
@@ -10,16 +11,29 @@ struct RetiredPlayerInfo {
     std::string name_;
     int score_;
     int play_time_ms_;
+    // UUID записи, как id в БД. Последний ключ порядка таблицы рекордов: без него курсор
+    // пропускал бы записи с теми же очками, временем и именем
+    std::string id_{};
 };
 
+// Порядок таблицы рекордов: очки по убыванию, время, имя побайтно, id. Должен совпадать
+// с ORDER BY запросов к БД (score DESC, play_time_ms, name COLLATE "C", id)
+struct RecordsLess {
+    bool operator()(const RetiredPlayerInfo & lhs, const RetiredPlayerInfo & rhs) const;
+};
+
+// Целое поле записи или курсора: вся строка, без пробелов и знака +
+std::optional<int> ParseRecordInt(std::string_view text);
+
 class UseCases {
 public:
     using players_list_t = std::vector<RetiredPlayerInfo>;
 
     virtual void AddPlayerRetired(const RetiredPlayerInfo & player) = 0;
     virtual players_list_t GetPlayersRetired(int offset, int limit) = 0;
-protected:
-    ~UseCases() = default;
+    virtual players_list_t GetPlayersRetiredAfter(const RetiredPlayerInfo & after, int limit) = 0;
+
+    virtual ~UseCases() = default;
 };
 
 }  // namespace app
\ No newline at end of file
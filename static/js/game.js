@@ -173,6 +173,28 @@ class GameState {
       self.playersLoaded = true;
       self._startGame();
     });
+    this._connectStateSocket();
+  }
+
+  // Сервер сам присылает состояние после каждого тика, опрос /state не нужен
+  _connectStateSocket() {
+    if (!window.WebSocket)
+      return;
+    const self = this;
+    const protocol = location.protocol == 'https:' ? 'wss://' : 'ws://';
+    const socket = new WebSocket(protocol + location.host + '/api/v1/game/state?token=' + Cookies.get('authToken'));
+    socket.onmessage = function(event) {
+      self.desiredState = JSON.parse(event.data);
+      self.stateTime = performance.now();
+      if (self.started)
+        self._applyDesiredState();
+    };
+    socket.onclose = function() {
+      self.stateSocket = undefined;
+    };
+    socket.onopen = function() {
+      self.stateSocket = socket;
+    };
   }
 
   tick() {
@@ -183,7 +205,7 @@ class GameState {
     if (!this.started)
       return false;
 
-    if ((this.ticks % this.posUpdateInterval == 0 || this.requestInstantUpdate) && !this.updateInProgress) {
+    if (!this.stateSocket && (this.ticks % this.posUpdateInterval == 0 || this.requestInstantUpdate) && !this.updateInProgress) {
       this.requestInstantUpdate = false;
       this._updateState(function() {
         self._applyDesiredState();
@@ -212,6 +234,11 @@ class GameState {
 
   _pressKey(keys, then) {
     const self = this;
+    if (this.stateSocket) {
+      this.stateSocket.send(JSON.stringify({move: keys}));
+      then();
+      return;
+    }
     $.post({
       url: '/api/v1/game/player/action',
       dataType: 'json',
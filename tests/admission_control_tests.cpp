@@ -0,0 +1,73 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/admission_control.h"
+
+using namespace std::literals;
+using Priority = http_server::AdmissionControl::Priority;
+
+SCENARIO("admission control") {
+    GIVEN("default limits") {
+        http_server::AdmissionControl control;
+        THEN("everything is admitted") {
+            int admitted = 0;
+            for (int i = 0; i < 1000; ++i)
+                admitted += control.TryAcquireConnection() && control.TryEnterQueue(Priority::LOW);
+            CHECK(admitted == 1000);
+            CHECK(control.Connections() == 1000);
+            CHECK(control.Pending() == 1000);
+        }
+    }
+
+    GIVEN("a queue limited to 8 requests") {
+        http_server::AdmissionControl control;
+        control.Configure({0, 8});
+
+        WHEN("the queue is half full") {
+            for (int i = 0; i < 4; ++i)
+                REQUIRE(control.TryEnterQueue(Priority::HIGH));
+            THEN("low priority work is shed first") {
+                CHECK_FALSE(control.Admit(Priority::LOW));
+                CHECK_FALSE(control.TryEnterQueue(Priority::LOW));
+                CHECK(control.TryEnterQueue(Priority::NORMAL));
+                CHECK(control.TryEnterQueue(Priority::NORMAL));
+                CHECK_FALSE(control.TryEnterQueue(Priority::NORMAL));
+                CHECK(control.TryEnterQueue(Priority::HIGH));
+                CHECK(control.TryEnterQueue(Priority::HIGH));
+                CHECK_FALSE(control.TryEnterQueue(Priority::HIGH));
+                CHECK(control.Pending() == 8);
+            }
+            AND_WHEN("requests leave the queue") {
+                for (int i = 0; i < 4; ++i)
+                    control.LeaveQueue();
+                THEN("low priority work is admitted again") { CHECK(control.Admit(Priority::LOW)); }
+            }
+        }
+    }
+
+    GIVEN("a connection limit") {
+        http_server::AdmissionControl control;
+        control.Configure({2, 0, std::chrono::seconds(3)});
+        CHECK(control.TryAcquireConnection());
+        CHECK(control.TryAcquireConnection());
+        CHECK_FALSE(control.TryAcquireConnection());
+        control.ReleaseConnection();
+        CHECK(control.TryAcquireConnection());
+
+        THEN("rejected connections get a complete 503 response") {
+            const auto& response = *control.ConnectionRejectResponse();
+            CHECK(response.rfind("HTTP/1.1 503 Service Unavailable\r\n", 0) == 0);
+            CHECK(response.find("Retry-After: 3\r\n") != std::string::npos);
+            auto body = response.substr(response.find("\r\n\r\n") + 4);
+            CHECK(response.find("Content-Length: "s + std::to_string(body.size()) + "\r\n") != std::string::npos);
+        }
+    }
+
+    GIVEN("route patterns") {
+        THEN("gameplay routes get the highest priority") {
+            CHECK(http_server::AdmissionControl::ClassifyRoute("/api/v1/game/player/action"sv) == Priority::HIGH);
+            CHECK(http_server::AdmissionControl::ClassifyRoute("/api/v1/game/state"sv) == Priority::HIGH);
+            CHECK(http_server::AdmissionControl::ClassifyRoute("/api/v1/game/records"sv) == Priority::LOW);
+            CHECK(http_server::AdmissionControl::ClassifyRoute("/api/v1/maps/{id}"sv) == Priority::NORMAL);
+        }
+    }
+}
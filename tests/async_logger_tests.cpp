@@ -0,0 +1,184 @@
+#include <catch2/catch_test_macros.hpp>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "../src/async_logger.h"
+
+using namespace std::literals;
+
+namespace {
+
+std::string StripTimestamp(const std::string& line) {
+    auto begin = line.find("\",\"data\"");
+    return begin == std::string::npos ? line : line.substr(begin);
+}
+
+}  // namespace
+
+SCENARIO("mpsc ring") {
+    GIVEN("several producers") {
+        async_logger::MpscRing<uint64_t, 1024> ring;
+        constexpr uint64_t PRODUCERS = 4;
+        constexpr uint64_t PER_PRODUCER = 20000;
+
+        std::vector<std::thread> producers;
+        for (uint64_t p = 0; p < PRODUCERS; ++p) {
+            producers.emplace_back([&ring, p] {
+                for (uint64_t i = 0; i < PER_PRODUCER; ++i)
+                    while (!ring.TryPush([&](uint64_t& value) { value = p * PER_PRODUCER + i; }))
+                        std::this_thread::yield();
+            });
+        }
+
+        std::vector<uint64_t> last(PRODUCERS, 0);
+        std::set<uint64_t> seen;
+        bool ordered = true;
+        while (seen.size() < PRODUCERS * PER_PRODUCER) {
+            ring.TryPop([&](uint64_t value) {
+                auto producer = value / PER_PRODUCER;
+                // Записи одного писателя приходят в порядке записи
+                if (seen.count(value) || (value % PER_PRODUCER != 0 && last[producer] + 1 != value))
+                    ordered = false;
+                last[producer] = value;
+                seen.insert(value);
+            });
+        }
+        for (auto& producer : producers)
+            producer.join();
+
+        THEN("every value is received once and in per-producer order") {
+            CHECK(ordered);
+            CHECK(ring.Empty());
+        }
+    }
+}
+
+SCENARIO("async logger") {
+    GIVEN("a logger writing into a string") {
+        std::mutex mutex;
+        std::string output;
+        async_logger::Logger logger;
+        logger.Start([&](std::string_view text) {
+            std::lock_guard lock(mutex);
+            output += text;
+        });
+
+        WHEN("records are logged") {
+            logger.Log("request received"sv, {{"ip", "127.0.0.1"s}, {"URI", "/api/v1/maps"sv}, {"method", "GET"}});
+            logger.Log("response sent"sv, {{"response_time", 12ll}, {"code", 200}, {"content_type", "application/json"sv}});
+            logger.Log("server exited"sv);
+            logger.Stop();
+
+            THEN("lines keep the Boost.Log json format") {
+                std::vector<std::string> lines;
+                for (size_t pos = 0, next; (next = output.find('\n', pos)) != std::string::npos; pos = next + 1)
+                    lines.push_back(output.substr(pos, next - pos));
+                REQUIRE(lines.size() == 3);
+                CHECK(lines[0].rfind("{\"timestamp\":\"", 0) == 0);
+                CHECK(StripTimestamp(lines[0]) ==
+                      "\",\"data\":{\"ip\":\"127.0.0.1\",\"URI\":\"\\/api\\/v1\\/maps\",\"method\":\"GET\"},\"message\":\"request received\"}"s);
+                CHECK(StripTimestamp(lines[1]) ==
+                      "\",\"data\":{\"response_time\":12,\"code\":200,\"content_type\":\"application\\/json\"},\"message\":\"response sent\"}"s);
+                CHECK(StripTimestamp(lines[2]) == "\",\"data\":\"\",\"message\":\"server exited\"}"s);
+                CHECK(logger.Written() == 3);
+            }
+        }
+        WHEN("a preformatted line is longer than a record") {
+            std::string data(async_logger::Record::TEXT_SIZE * 3, 'x');
+            auto line = "{\"timestamp\":\"now\",\"data\":{\"exception\":\""s + data + "\"},\"message\":\"error\"}\n"s;
+            logger.LogRaw("{\"message\":\"short\"}\n"sv);
+            logger.LogRaw(line);
+            logger.Stop();
+
+            THEN("it is written whole, not cut in the middle of the json") {
+                CHECK(output == "{\"message\":\"short\"}\n"s + line);
+                CHECK(logger.Written() == 2);
+            }
+        }
+    }
+
+    GIVEN("a logger whose thread is not running") {
+        async_logger::Logger logger;
+        WHEN("the queue overflows") {
+            for (size_t i = 0; i < async_logger::Logger::QUEUE_SIZE + 10; ++i)
+                logger.Log("request received"sv, {{"code", 200}});
+            THEN("extra records are dropped and counted") { CHECK(logger.Dropped() == 10); }
+        }
+        WHEN("the queue overflows with long raw lines") {
+            std::string line(async_logger::Record::TEXT_SIZE + 1, 'x');
+            for (size_t i = 0; i < async_logger::Logger::QUEUE_SIZE + 10; ++i)
+                logger.LogRaw(line);
+            THEN("dropped lines are released right away") { CHECK(logger.Dropped() == 10); }
+        }
+    }
+}
+
+SCENARIO("log filter") {
+    using async_logger::Category;
+    using async_logger::Level;
+
+    GIVEN("default settings") {
+        async_logger::Filter filter;
+        THEN("info is logged without sampling") {
+            CHECK(filter.Enabled(Category::REQUEST, Level::INFO));
+            CHECK_FALSE(filter.Enabled(Category::SERVER, Level::DEBUG));
+            CHECK(filter.Sample(Category::RESPONSE));
+            CHECK(filter.Sample(Category::RESPONSE));
+        }
+
+        WHEN("a config is applied") {
+            filter.Apply("# нагрузочный режим\n"
+                         "request info 10\n"
+                         "response warning\n"
+                         "server debug\n"
+                         "slow-request-ms 200\n"sv);
+            THEN("levels, sampling and slow threshold change") {
+                CHECK(filter.Enabled(Category::SERVER, Level::DEBUG));
+                CHECK_FALSE(filter.Enabled(Category::RESPONSE, Level::INFO));
+                CHECK(filter.Enabled(Category::RESPONSE, Level::WARNING));
+                CHECK(filter.IsSlow(std::chrono::milliseconds(200)));
+                CHECK_FALSE(filter.IsSlow(std::chrono::milliseconds(199)));
+
+                int sampled = 0;
+                for (int i = 0; i < 100; ++i)
+                    sampled += filter.Sample(Category::REQUEST);
+                CHECK(sampled == 10);
+            }
+        }
+
+        WHEN("a config is invalid") {
+            CHECK_THROWS_AS(filter.Apply("request info\nresponse loud\n"sv), std::invalid_argument);
+            THEN("nothing changes") { CHECK(filter.Enabled(Category::RESPONSE, Level::INFO)); }
+        }
+
+        WHEN("a config is reloaded") {
+            filter.Apply("server debug\nrequest info 10\n"sv);
+            filter.Replace("response warning\n"sv);
+            THEN("settings missing from the new config return to defaults") {
+                CHECK_FALSE(filter.Enabled(Category::SERVER, Level::DEBUG));
+                CHECK(filter.Sample(Category::REQUEST));
+                CHECK(filter.Sample(Category::REQUEST));
+                CHECK_FALSE(filter.Enabled(Category::RESPONSE, Level::INFO));
+            }
+            AND_WHEN("the new config is invalid") {
+                CHECK_THROWS_AS(filter.Replace("server debug\nresponse loud\n"sv), std::invalid_argument);
+                THEN("the previous settings are kept") {
+                    CHECK_FALSE(filter.Enabled(Category::SERVER, Level::DEBUG));
+                    CHECK_FALSE(filter.Enabled(Category::RESPONSE, Level::INFO));
+                }
+            }
+        }
+
+        WHEN("everything is enabled") {
+            filter.Apply("request error 100\n"sv);
+            filter.EnableAll();
+            THEN("trace passes and sampling is off") {
+                CHECK(filter.Enabled(Category::REQUEST, Level::TRACE));
+                CHECK(filter.Sample(Category::REQUEST));
+            }
+        }
+    }
+}
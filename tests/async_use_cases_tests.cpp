@@ -0,0 +1,120 @@
+#include <catch2/catch_test_macros.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/strand.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "../src/async_use_cases.h"
+#include "../src/executors.h"
+
+using namespace std::literals;
+using Status = app::AsyncUseCases::Status;
+
+namespace {
+
+// Запросы ждут, пока тест не откроет release
+class FakeUseCases : public app::UseCases {
+   public:
+    void AddPlayerRetired(const app::RetiredPlayerInfo& player) override {
+        std::lock_guard lock(mutex_);
+        added_.push_back(player);
+    }
+    players_list_t GetPlayersRetired(int offset, int limit) override {
+        Wait();
+        if (offset < 0) 
+            throw std::runtime_error("bad offset");
+        return players_list_t(limit, {"dog", offset, 0});
+    }
+    players_list_t GetPlayersRetiredAfter(const app::RetiredPlayerInfo& after, int limit) override {
+        Wait();
+        return players_list_t(limit, after);
+    }
+
+    void Release() {
+        {
+            std::lock_guard lock(mutex_);
+            released_ = true;
+        }
+        cv_.notify_all();
+    }
+    size_t Added() {
+        std::lock_guard lock(mutex_);
+        return added_.size();
+    }
+
+   private:
+    void Wait() {
+        std::unique_lock lock(mutex_);
+        cv_.wait(lock, [this] { return released_; });
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool released_ = false;
+    players_list_t added_;
+};
+
+}  // namespace
+
+SCENARIO("async use cases") {
+    FakeUseCases use_cases;
+    executors::ThreadPool db_pool(2);
+    boost::asio::io_context reply;
+    auto strand = boost::asio::make_strand(reply);
+
+    std::vector<Status> statuses;
+    auto record = [&statuses](Status status, app::UseCases::players_list_t) { statuses.push_back(status); };
+
+    GIVEN("a queue of two queries without a timeout") {
+        app::AsyncUseCases async(use_cases, db_pool.GetExecutor(), {2, 0ms});
+        db_pool.Start();
+        async.GetPlayersRetired(0, 3, strand, record);
+        async.GetPlayersRetiredAfter({"rex", 1, 2}, 1, strand, record);
+        async.GetPlayersRetired(0, 3, strand, record);
+
+        THEN("the query over the limit is rejected at once") {
+            reply.run_for(50ms);
+            reply.restart();
+            CHECK(statuses == std::vector{Status::OVERLOADED});
+            CHECK(async.Pending() == 2);
+
+            use_cases.Release();
+            db_pool.Drain();
+            reply.run();
+            CHECK(statuses == std::vector{Status::OVERLOADED, Status::OK, Status::OK});
+            CHECK(async.Pending() == 0);
+        }
+    }
+
+    GIVEN("a short timeout") {
+        app::AsyncUseCases async(use_cases, db_pool.GetExecutor(), {0, 20ms});
+        db_pool.Start();
+        async.GetPlayersRetired(0, 3, strand, record);
+        THEN("the caller gets TIMEOUT once, even if the query finishes later") {
+            reply.run_for(200ms);
+            reply.restart();
+            CHECK(statuses == std::vector{Status::TIMEOUT});
+            use_cases.Release();
+            db_pool.Drain();
+            reply.run();
+            CHECK(statuses == std::vector{Status::TIMEOUT});
+        }
+    }
+
+    GIVEN("a failing query and a retirement") {
+        app::AsyncUseCases async(use_cases, db_pool.GetExecutor(), {});
+        use_cases.Release();
+        db_pool.Start();
+        async.GetPlayersRetired(-1, 3, strand, record);
+        async.AddPlayerRetired({"rex", 10, 1000});
+        db_pool.Drain();
+        reply.run();
+        THEN("the error is reported and the insert is done") {
+            CHECK(statuses == std::vector{Status::FAILED});
+            CHECK(use_cases.Added() == 1);
+        }
+    }
+}
@@ -0,0 +1,103 @@
+#include <boost/beast/zlib/inflate_stream.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/compression.h"
+
+using namespace std::literals;
+namespace http = boost::beast::http;
+using compression::Encoding;
+
+namespace {
+
+std::string Inflate(std::string_view raw_deflate, size_t expected_size) {
+    boost::beast::zlib::inflate_stream stream;
+    std::string out(expected_size, '\0');
+    boost::beast::zlib::z_params params;
+    params.next_in = raw_deflate.data();
+    params.avail_in = raw_deflate.size();
+    params.next_out = out.data();
+    params.avail_out = out.size();
+    boost::beast::error_code ec;
+    stream.write(params, boost::beast::zlib::Flush::finish, ec);
+    out.resize(out.size() - params.avail_out);
+    return out;
+}
+
+std::string MakeJson() {
+    std::string json = "[";
+    for (int i = 0; i < 500; ++i)
+        json += "{\"name\":\"dog\",\"score\":" + std::to_string(i) + "},";
+    json.back() = ']';
+    return json;
+}
+
+}  // namespace
+
+SCENARIO("accept-encoding negotiation") {
+    CHECK(compression::NegotiateEncoding("gzip, deflate, br"sv) == Encoding::GZIP);
+    CHECK(compression::NegotiateEncoding("deflate"sv) == Encoding::DEFLATE);
+    CHECK(compression::NegotiateEncoding("gzip;q=0.5, deflate"sv) == Encoding::DEFLATE);
+    CHECK(compression::NegotiateEncoding("gzip;q=0"sv) == Encoding::IDENTITY);
+    CHECK(compression::NegotiateEncoding("*"sv) == Encoding::GZIP);
+    CHECK(compression::NegotiateEncoding("gzip;q=0, *"sv) == Encoding::DEFLATE);
+    CHECK(compression::NegotiateEncoding("*, gzip;q=0, deflate;q=0"sv) == Encoding::IDENTITY);
+    CHECK(compression::NegotiateEncoding("deflate;q=0.5, *;q=0.8"sv) == Encoding::GZIP);
+    CHECK(compression::NegotiateEncoding(""sv) == Encoding::IDENTITY);
+    // q только как отдельный параметр, имя без учета регистра
+    CHECK(compression::NegotiateEncoding("gzip;freq=0, deflate;q=0.5"sv) == Encoding::GZIP);
+    CHECK(compression::NegotiateEncoding("gzip; level=1; Q = 0, deflate"sv) == Encoding::DEFLATE);
+}
+
+SCENARIO("gzip and deflate framing") {
+    auto json = MakeJson();
+
+    WHEN("data is gzipped") {
+        auto gzip = compression::Compress(json, Encoding::GZIP, compression::DYNAMIC_LEVEL);
+        THEN("header, deflate stream and size trailer are valid") {
+            REQUIRE(gzip.size() > 18);
+            CHECK(gzip.size() < json.size());
+            CHECK(static_cast<unsigned char>(gzip[0]) == 0x1f);
+            CHECK(static_cast<unsigned char>(gzip[1]) == 0x8b);
+            auto isize = static_cast<uint32_t>(static_cast<unsigned char>(gzip[gzip.size() - 4])) |
+                         static_cast<uint32_t>(static_cast<unsigned char>(gzip[gzip.size() - 3])) << 8;
+            CHECK(isize == (json.size() & 0xffff));
+            CHECK(Inflate(std::string_view(gzip).substr(10, gzip.size() - 18), json.size()) == json);
+        }
+    }
+    WHEN("data is deflated") {
+        auto deflate = compression::Compress(json, Encoding::DEFLATE, compression::STATIC_LEVEL);
+        THEN("zlib header is valid and stream inflates back") {
+            CHECK((static_cast<unsigned char>(deflate[0]) * 256 + static_cast<unsigned char>(deflate[1])) % 31 == 0);
+            CHECK(Inflate(std::string_view(deflate).substr(2, deflate.size() - 6), json.size()) == json);
+        }
+    }
+}
+
+SCENARIO("dynamic response compression") {
+    GIVEN("a large JSON response") {
+        StringResponse resp(http::status::ok, 11);
+        resp.set(http::field::content_type, "application/json");
+        auto json = MakeJson();
+        resp.body() = json;
+
+        WHEN("client accepts gzip") {
+            compression::CompressResponse(resp, Encoding::GZIP);
+            THEN("body is compressed and headers are set") {
+                CHECK(resp[http::field::content_encoding] == "gzip");
+                CHECK(resp[http::field::vary] == "Accept-Encoding");
+                CHECK(resp.body().size() < json.size());
+                CHECK(resp[http::field::content_length] == std::to_string(resp.body().size()));
+            }
+        }
+    }
+    GIVEN("a small response") {
+        StringResponse resp(http::status::ok, 11);
+        resp.set(http::field::content_type, "application/json");
+        resp.body() = "{}";
+        compression::CompressResponse(resp, Encoding::GZIP);
+        THEN("it is left as is") {
+            CHECK(resp.body() == "{}");
+            CHECK(resp.count(http::field::content_encoding) == 0);
+        }
+    }
+}
@@ -0,0 +1,38 @@
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <boost/asio/post.hpp>
+#include <stdexcept>
+
+#include "../src/executors.h"
+
+SCENARIO("cpu lists") {
+    GIVEN("ranges and single cpus") {
+        THEN("they are expanded in order") {
+            CHECK(executors::ParseCpuList("0-3,6") == executors::CpuSet{0, 1, 2, 3, 6});
+            CHECK(executors::ParseCpuList("5") == executors::CpuSet{5});
+            CHECK(executors::ParseCpuList("").empty());
+        }
+    }
+    GIVEN("malformed lists") {
+        THEN("they are rejected") {
+            CHECK_THROWS_AS(executors::ParseCpuList("3-1"), std::invalid_argument);
+            CHECK_THROWS_AS(executors::ParseCpuList("a"), std::invalid_argument);
+            CHECK_THROWS_AS(executors::ParseCpuList("1,"), std::invalid_argument);
+            CHECK_THROWS_AS(executors::ParseCpuList("-2"), std::invalid_argument);
+        }
+    }
+}
+
+SCENARIO("thread pool") {
+    GIVEN("a pool with queued work") {
+        executors::ThreadPool pool(2);
+        std::atomic<int> done = 0;
+        for (int i = 0; i < 100; ++i)
+            boost::asio::post(pool.GetExecutor(), [&done] { ++done; });
+        WHEN("it is started and drained") {
+            pool.Start();
+            pool.Drain();
+            THEN("all work is done") { CHECK(done == 100); }
+        }
+    }
+}
@@ -0,0 +1,241 @@
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/write.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <variant>
+
+#include "../src/http_server.h"
+
+using namespace std::literals;
+
+namespace {
+
+namespace net = boost::asio;
+namespace http = boost::beast::http;
+using tcp = net::ip::tcp;
+using Response = http::response<http::string_body>;
+
+// Обработчик, который копит запросы и отвечает на них, когда велит тест
+struct PendingRequests {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<std::pair<std::string, std::function<void(Response&&)>>> requests;
+    std::vector<std::shared_ptr<http_server::WebSocketSession>> upgrades;
+    std::vector<http_message::StringRequest> upgrade_requests;
+
+    bool WaitFor(std::function<bool()> condition, std::chrono::milliseconds timeout = 2s) {
+        std::unique_lock lock(mutex);
+        return changed.wait_for(lock, timeout, std::move(condition));
+    }
+    size_t Count() {
+        std::lock_guard lock(mutex);
+        return requests.size();
+    }
+    void Reply(size_t index) {
+        std::function<void(Response&&)> send;
+        std::string target;
+        {
+            std::lock_guard lock(mutex);
+            target = requests.at(index).first;
+            send = requests[index].second;
+        }
+        Response response(http::status::ok, 11);
+        response.set(http::field::content_type, "text/plain");
+        response.body() = target;
+        response.prepare_payload();
+        send(std::move(response));
+    }
+};
+
+struct TestHandler {
+    std::shared_ptr<PendingRequests> pending;
+
+    template <typename Send>
+    void operator()(http_message::StringRequest& request, Send&& send) {
+        std::lock_guard lock(pending->mutex);
+        pending->requests.emplace_back(std::string(request.target()), [send](Response&& response) mutable {
+            send(std::variant<Response>(std::move(response)));
+        });
+        pending->changed.notify_all();
+    }
+    void operator()(http_message::StringRequest&& request, std::shared_ptr<http_server::WebSocketSession> ws) {
+        std::lock_guard lock(pending->mutex);
+        pending->upgrade_requests.push_back(std::move(request));
+        pending->upgrades.push_back(std::move(ws));
+        pending->changed.notify_all();
+    }
+};
+
+// Сервер с одной сессией на своем потоке и синхронный клиент
+class PipelineFixture {
+   public:
+    PipelineFixture() : acceptor_(ioc_, tcp::endpoint(net::ip::address_v4::loopback(), 0)), client_(ioc_) {
+        client_.connect(acceptor_.local_endpoint());
+        auto socket = acceptor_.accept();
+        http_server::AdmissionControl::Instance().TryAcquireConnection();
+        std::make_shared<http_server::Session<TestHandler>>(std::move(socket), TestHandler{pending_}, ioc_)->Run();
+        thread_ = std::thread([this] { ioc_.run(); });
+    }
+    ~PipelineFixture() {
+        boost::system::error_code ec;
+        client_.close(ec);
+        {
+            std::lock_guard lock(pending_->mutex);
+            pending_->requests.clear();
+            pending_->upgrades.clear();
+            pending_->upgrade_requests.clear();
+        }
+        work_.reset();
+        ioc_.stop();
+        thread_.join();
+    }
+
+    void SendRequests(const std::vector<std::string>& targets) {
+        std::string raw;
+        for (const auto& target : targets) 
+            raw += "GET "s + target + " HTTP/1.1\r\nHost: localhost\r\n\r\n"s;
+        net::write(client_, net::buffer(raw));
+    }
+    void SendUpgrade() {
+        net::write(client_, net::buffer("GET /ws HTTP/1.1\r\nHost: localhost\r\nConnection: Upgrade\r\nUpgrade: websocket\r\n"
+                                        "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n"sv));
+    }
+    std::string ReadResponseBody() {
+        Response response;
+        http::read(client_, buffer_, response);
+        return response.body();
+    }
+
+    // Первый байт кадра WebSocket после ответа 101
+    uint8_t ReadFrameAfterUpgrade() {
+        http::response<http::empty_body> response;
+        http::read(client_, buffer_, response);
+        if (buffer_.size() == 0) 
+            buffer_.commit(client_.read_some(buffer_.prepare(64)));
+        return *static_cast<const uint8_t*>(buffer_.data().data());
+    }
+
+    PendingRequests& Pending() { return *pending_; }
+
+   private:
+    net::io_context ioc_;
+    net::executor_work_guard<net::io_context::executor_type> work_ = net::make_work_guard(ioc_);
+    tcp::acceptor acceptor_;
+    tcp::socket client_;
+    boost::beast::flat_buffer buffer_;
+    std::shared_ptr<PendingRequests> pending_ = std::make_shared<PendingRequests>();
+    std::thread thread_;
+};
+
+}  // namespace
+
+SCENARIO("http pipelining") {
+    GIVEN("a connection with three pipelined requests") {
+        PipelineFixture fixture;
+        fixture.SendRequests({"/a", "/b", "/c"});
+        REQUIRE(fixture.Pending().WaitFor([&] { return fixture.Pending().requests.size() == 3; }));
+
+        WHEN("handlers complete in reverse order") {
+            fixture.Pending().Reply(2);
+            fixture.Pending().Reply(1);
+            fixture.Pending().Reply(0);
+            THEN("responses are written in request order") {
+                CHECK(fixture.ReadResponseBody() == "/a"s);
+                CHECK(fixture.ReadResponseBody() == "/b"s);
+                CHECK(fixture.ReadResponseBody() == "/c"s);
+            }
+        }
+    }
+
+    GIVEN("more pipelined requests than MAX_PIPELINE") {
+        constexpr size_t total = http_server::SessionBase::MAX_PIPELINE + 2;
+        PipelineFixture fixture;
+        std::vector<std::string> targets;
+        for (size_t i = 0; i < total; ++i) 
+            targets.push_back("/"s + std::to_string(i));
+        fixture.SendRequests(targets);
+
+        THEN("only MAX_PIPELINE requests are in flight until one is answered") {
+            REQUIRE(fixture.Pending().WaitFor([&] { return fixture.Pending().requests.size() == http_server::SessionBase::MAX_PIPELINE; }));
+            CHECK_FALSE(fixture.Pending().WaitFor([&] { return fixture.Pending().requests.size() > http_server::SessionBase::MAX_PIPELINE; }, 100ms));
+
+            fixture.Pending().Reply(0);
+            CHECK(fixture.ReadResponseBody() == "/0"s);
+            REQUIRE(fixture.Pending().WaitFor([&] { return fixture.Pending().requests.size() == http_server::SessionBase::MAX_PIPELINE + 1; }));
+
+            for (size_t i = 1; i < http_server::SessionBase::MAX_PIPELINE + 1; ++i) 
+                fixture.Pending().Reply(i);
+            REQUIRE(fixture.Pending().WaitFor([&] { return fixture.Pending().requests.size() == total; }));
+            fixture.Pending().Reply(total - 1);
+            for (size_t i = 1; i < total; ++i) 
+                CHECK(fixture.ReadResponseBody() == targets[i]);
+        }
+    }
+
+    GIVEN("an upgrade request behind a request in flight") {
+        PipelineFixture fixture;
+        fixture.SendRequests({"/a"});
+        REQUIRE(fixture.Pending().WaitFor([&] { return fixture.Pending().requests.size() == 1; }));
+        fixture.SendUpgrade();
+
+        THEN("the socket is handed over only after the pending response is written") {
+            CHECK_FALSE(fixture.Pending().WaitFor([&] { return !fixture.Pending().upgrades.empty(); }, 100ms));
+            fixture.Pending().Reply(0);
+            CHECK(fixture.ReadResponseBody() == "/a"s);
+            CHECK(fixture.Pending().WaitFor([&] { return fixture.Pending().upgrades.size() == 1; }));
+            CHECK(fixture.Pending().Count() == 1);
+        }
+    }
+
+    GIVEN("more connections than pthread keys") {
+        net::io_context ioc;
+        std::vector<std::shared_ptr<http_server::Session<TestHandler>>> sessions;
+        THEN("every session gets its memory pool") {
+            CHECK_NOTHROW([&] {
+                for (size_t i = 0; i < 2048; ++i) {
+                    http_server::AdmissionControl::Instance().TryAcquireConnection();
+                    sessions.push_back(std::make_shared<http_server::Session<TestHandler>>(tcp::socket(ioc), TestHandler{}, ioc));
+                }
+            }());
+        }
+    }
+
+    GIVEN("an upgraded connection") {
+        auto& admission = http_server::AdmissionControl::Instance();
+        const auto before = admission.Connections();
+        PipelineFixture fixture;
+        fixture.SendUpgrade();
+        REQUIRE(fixture.Pending().WaitFor([&] { return fixture.Pending().upgrades.size() == 1; }));
+
+        THEN("it keeps its admission slot until the websocket session is gone") {
+            // HTTP сессия к этому времени уже завершилась
+            std::this_thread::sleep_for(100ms);
+            CHECK(admission.Connections() == before + 1);
+            {
+                std::lock_guard lock(fixture.Pending().mutex);
+                fixture.Pending().upgrades.clear();
+            }
+            CHECK(admission.Connections() == before);
+        }
+    }
+
+    GIVEN("a websocket closed during its handshake") {
+        PipelineFixture fixture;
+        fixture.SendUpgrade();
+        REQUIRE(fixture.Pending().WaitFor([&] { return fixture.Pending().upgrades.size() == 1; }));
+        {
+            std::lock_guard lock(fixture.Pending().mutex);
+            auto& ws = fixture.Pending().upgrades.front();
+            ws->Run(std::move(fixture.Pending().upgrade_requests.front()), [](std::string&&) {});
+            ws->Close();
+        }
+        THEN("the close frame follows the handshake") {
+            constexpr uint8_t FIN_CLOSE = 0x88;
+            CHECK(fixture.ReadFrameAfterUpgrade() == FIN_CLOSE);
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "../src/json_request.h"
+
+using namespace std::literals;
+using json_loader::RequestFields;
+
+SCENARIO("request body fields") {
+    GIVEN("a join request") {
+        RequestFields fields(R"({"userName": "Scooby \"Doo\"", "mapId": "map1"})"sv);
+        THEN("strings are returned unescaped") {
+            CHECK(fields.Get("userName"sv) == "Scooby \"Doo\""s);
+            CHECK(fields.Get("mapId"sv) == "map1"s);
+            CHECK_THROWS_AS(fields.Get("missing"sv), std::invalid_argument);
+        }
+    }
+
+    GIVEN("numbers") {
+        RequestFields fields(R"({"timeDelta": 100.5, "negative": -7, "big": 18446744073709551615, "exp": 1e2})"sv);
+        THEN("they keep the text from the body, as ptree did") {
+            CHECK(fields.Get("timeDelta"sv) == "100.5"s);
+            CHECK(atoi(fields.Get("timeDelta"sv).c_str()) == 100);
+            CHECK(fields.Get("negative"sv) == "-7"s);
+            CHECK(fields.Get("big"sv) == "18446744073709551615"s);
+            CHECK(fields.Get("exp"sv) == "1e2"s);
+        }
+    }
+
+    GIVEN("bools, null and nested values") {
+        RequestFields fields(R"({"on": true, "off": false, "none": null, "obj": {"move": "L"}, "list": [1, 2], "move": "R"})"sv);
+        THEN("scalars are returned as text, containers as an empty string") {
+            CHECK(fields.Get("on"sv) == "true"s);
+            CHECK(fields.Get("off"sv) == "false"s);
+            CHECK(fields.Get("none"sv) == "null"s);
+            CHECK(fields.Get("obj"sv).empty());
+            CHECK(fields.Get("list"sv).empty());
+            CHECK(fields.Get("move"sv) == "R"s);
+        }
+    }
+
+    GIVEN("a duplicated key") {
+        RequestFields fields(R"({"move": "U", "move": "D"})"sv);
+        THEN("the first value wins") { CHECK(fields.Get("move"sv) == "U"s); }
+    }
+
+    GIVEN("malformed bodies") {
+        THEN("parsing throws") {
+            CHECK_THROWS_AS(RequestFields(""sv), std::invalid_argument);
+            CHECK_THROWS_AS(RequestFields(R"({"move": "U")"sv), std::invalid_argument);
+            CHECK_THROWS_AS(RequestFields(R"({"move": "U"} trailing)"sv), std::invalid_argument);
+            CHECK_THROWS_AS(RequestFields(R"(["move", "U"])"sv), std::invalid_argument);
+            CHECK_THROWS_AS(RequestFields(R"("move")"sv), std::invalid_argument);
+        }
+    }
+}
@@ -0,0 +1,114 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/leaderboard.h"
+
+using namespace std::literals;
+
+SCENARIO("leaderboard") {
+    GIVEN("an empty table") {
+        app::Leaderboard board(3);
+        board.Warm({});
+        THEN("every page is answered from memory") {
+            REQUIRE(board.Page(0, 100));
+            CHECK(board.Page(0, 100)->json == "[]");
+            CHECK(board.Page(50, 10)->json == "[]");
+            CHECK(board.Page(0, 100)->next_cursor.empty());
+        }
+
+        WHEN("players retire") {
+            board.Add({"b", 10, 2000});
+            board.Add({"a", 10, 2000});
+            board.Add({"c", 20, 5000});
+            board.Add({"d", 10, 1000});
+            THEN("they are ordered by score, play time and name") {
+                CHECK(board.Page(0, 3)->json ==
+                      app::Leaderboard::EncodePage({{"c", 20, 5000}, {"d", 10, 1000}, {"a", 10, 2000}}, 3).json);
+                CHECK(board.Page(1, 1)->json == app::Leaderboard::EncodePage({{"d", 10, 1000}}, 1).json);
+            }
+            THEN("a cursor continues right after the last row of a full page") {
+                auto first = board.Page(0, 2);
+                REQUIRE_FALSE(first->next_cursor.empty());
+                auto last = app::DecodeRecordsCursor(first->next_cursor);
+                REQUIRE(last);
+                CHECK(last->name_ == "d");
+                auto second = board.PageAfter(*last, 1);
+                REQUIRE(second);
+                CHECK(second->json == app::Leaderboard::EncodePage({{"a", 10, 2000}}, 1).json);
+                CHECK_FALSE(board.PageAfter(*last, 2));
+            }
+            THEN("pages past the cache go to the database") {
+                CHECK_FALSE(board.Page(0, 4));
+                CHECK_FALSE(board.Page(3, 1));
+            }
+        }
+    }
+
+    GIVEN("a table warmed with its top") {
+        app::Leaderboard board(2);
+        board.Warm({{"a", 30, 1000}, {"b", 20, 1000}});
+        THEN("the cache is not complete") { CHECK_FALSE(board.Page(0, 3)); }
+        WHEN("a player below the cache retires") {
+            board.Add({"c", 10, 1000});
+            THEN("the cache does not change") {
+                CHECK(board.Page(0, 2)->json == app::Leaderboard::EncodePage({{"a", 30, 1000}, {"b", 20, 1000}}, 2).json);
+            }
+        }
+        WHEN("a better player retires") {
+            board.Add({"c", 25, 1000});
+            THEN("the page is updated") {
+                CHECK(board.Page(0, 2)->json == app::Leaderboard::EncodePage({{"a", 30, 1000}, {"c", 25, 1000}}, 2).json);
+            }
+        }
+    }
+
+    GIVEN("players equal in score, play time and name") {
+        app::Leaderboard board(10);
+        board.Warm({});
+        board.Add({"dog", 10, 1000, "00000000-0000-4000-8000-000000000002"s});
+        board.Add({"dog", 10, 1000, "00000000-0000-4000-8000-000000000001"s});
+        board.Add({"dog", 10, 1000, "00000000-0000-4000-8000-000000000003"s});
+        THEN("a cursor walks through every one of them") {
+            std::vector<std::string> ids;
+            auto page = board.Page(0, 1);
+            while (page && !page->next_cursor.empty()) {
+                auto last = app::DecodeRecordsCursor(page->next_cursor);
+                REQUIRE(last);
+                ids.push_back(last->id_);
+                page = board.PageAfter(*last, 1);
+            }
+            CHECK(ids == std::vector{"00000000-0000-4000-8000-000000000001"s, "00000000-0000-4000-8000-000000000002"s,
+                                     "00000000-0000-4000-8000-000000000003"s});
+        }
+    }
+
+    GIVEN("players encoded like the database response") {
+        THEN("the page matches the records format") {
+            CHECK(app::Leaderboard::EncodePage({{"a", 5, 1500}, {"b", 3, 2000}}, 100).json ==
+                  "[{\"name\":\"a\",\"score\":5,\"playTime\":1.5}\n,\n{\"name\":\"b\",\"score\":3,\"playTime\":2}\n\n]"s);
+        }
+    }
+}
+
+SCENARIO("records cursor") {
+    GIVEN("a retired player") {
+        app::RetiredPlayerInfo player{"Rex: the \"dog\"", -5, 123456, "1b9d6bcd-bbfd-4b2d-9b5d-ab8dfbbd4bed"s};
+        THEN("the cursor round-trips") {
+            auto cursor = app::EncodeRecordsCursor(player);
+            CHECK(cursor.find_first_not_of("0123456789abcdef") == std::string::npos);
+            auto decoded = app::DecodeRecordsCursor(cursor);
+            REQUIRE(decoded);
+            CHECK(decoded->name_ == player.name_);
+            CHECK(decoded->score_ == player.score_);
+            CHECK(decoded->play_time_ms_ == player.play_time_ms_);
+            CHECK(decoded->id_ == player.id_);
+        }
+    }
+    GIVEN("damaged cursors") {
+        THEN("they are rejected") {
+            CHECK_FALSE(app::DecodeRecordsCursor("abc"));
+            CHECK_FALSE(app::DecodeRecordsCursor("zz"));
+            CHECK_FALSE(app::DecodeRecordsCursor(app::EncodeRecordsCursor({"", 1, 2}).substr(0, 4)));
+            CHECK_FALSE(app::DecodeRecordsCursor(app::EncodeRecordsCursor({"", 1, 2, "not-a-uuid"})));
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#include <catch2/catch_test_macros.hpp>
+#include <thread>
+#include <vector>
+
+#include "../src/metrics.h"
+
+using namespace std::literals;
+
+SCENARIO("metrics primitives") {
+    GIVEN("a counter incremented from several threads") {
+        metrics::Counter counter;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; ++t)
+            threads.emplace_back([&counter] {
+                for (int i = 0; i < 10000; ++i)
+                    counter.Inc();
+            });
+        for (auto& thread : threads)
+            thread.join();
+        THEN("shards add up") { CHECK(counter.Value() == 80000); }
+    }
+
+    GIVEN("a histogram") {
+        metrics::Histogram histogram({0.1, 1});
+        histogram.Observe(0.05);
+        histogram.Observe(0.1);
+        histogram.Observe(0.5);
+        histogram.Observe(5.0);
+        THEN("values fall into buckets by upper bound") {
+            auto snapshot = histogram.Collect();
+            CHECK(snapshot.buckets == std::vector<uint64_t>{2, 1, 1});
+            CHECK(snapshot.count == 4);
+            CHECK(snapshot.sum == 5.65);
+        }
+    }
+}
+
+SCENARIO("metrics registry") {
+    GIVEN("a registry with every kind of metric") {
+        metrics::Registry registry;
+        auto& requests = registry.AddHistogram("request_seconds", "Requests", {"route", "code"}, {0.01, 0.1});
+        requests.WithLabels({"/api/v1/maps", "200"}).Observe(0.005);
+        requests.WithLabels({"/api/v1/maps", "200"}).Observe(0.05);
+        registry.AddCounter("rejected_total", "Rejected", {"reason"}).WithLabels({"say \"hi\""}).Inc(3);
+        registry.AddGauge("connections", "Open connections").Get().Set(7);
+        registry.AddCallbackGauge("dogs", "Dogs", [] { return 42.0; });
+
+        THEN("it is serialized in the Prometheus text format") {
+            CHECK(&requests.WithLabels({"/api/v1/maps", "200"}) == &requests.WithLabels({"/api/v1/maps", "200"}));
+            CHECK(registry.Serialize() ==
+                  "# HELP rejected_total Rejected\n"
+                  "# TYPE rejected_total counter\n"
+                  "rejected_total{reason=\"say \\\"hi\\\"\"} 3\n"
+                  "# HELP connections Open connections\n"
+                  "# TYPE connections gauge\n"
+                  "connections 7\n"
+                  "# HELP dogs Dogs\n"
+                  "# TYPE dogs gauge\n"
+                  "dogs 42\n"
+                  "# HELP request_seconds Requests\n"
+                  "# TYPE request_seconds histogram\n"
+                  "request_seconds_bucket{route=\"/api/v1/maps\",code=\"200\",le=\"0.01\"} 1\n"
+                  "request_seconds_bucket{route=\"/api/v1/maps\",code=\"200\",le=\"0.1\"} 2\n"
+                  "request_seconds_bucket{route=\"/api/v1/maps\",code=\"200\",le=\"+Inf\"} 2\n"
+                  "request_seconds_sum{route=\"/api/v1/maps\",code=\"200\"} 0.055\n"
+                  "request_seconds_count{route=\"/api/v1/maps\",code=\"200\"} 2\n"s);
+        }
+    }
+}
@@ -0,0 +1,131 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <functional>
+#include <map>
+
+#include "../src/common.h"
+#include "../src/router.h"
+
+using namespace std::literals;
+namespace http = boost::beast::http;
+
+namespace {
+
+using TestRouter = router::Router<int>;
+
+TestRouter MakeApiRouter() {
+    TestRouter routes;
+    routes.Add(http::verb::get, "/api/v1/maps", 1);
+    routes.Add(http::verb::get, "/api/v1/maps/{id}", 2);
+    routes.Add(http::verb::post, "/api/v1/game/join", 3);
+    routes.Add(http::verb::get, "/api/v1/game/players", 4);
+    routes.Add(http::verb::get, "/api/v1/game/state", 5);
+    routes.Add(http::verb::get, "/api/v1/game/records", 6);
+    routes.Add(http::verb::post, "/api/v1/game/player/action", 7);
+    routes.Add(http::verb::post, "/api/v1/game/tick", 8);
+    return routes;
+}
+
+}  // namespace
+
+SCENARIO("route table lookup") {
+    GIVEN("api v1 routes") {
+        auto routes = MakeApiRouter();
+
+        WHEN("a literal path is requested") {
+            auto match = routes.Find(http::verb::post, "/api/v1/game/player/action");
+            THEN("its handler is found") {
+                REQUIRE(match);
+                REQUIRE(match->handler);
+                CHECK(*match->handler == 7);
+                CHECK(match->params.empty());
+            }
+        }
+        WHEN("a path with parameter and query is requested") {
+            auto match = routes.Find(http::verb::get, "/api/v1/maps/map1?x=1&y=2");
+            THEN("parameter and query are extracted") {
+                REQUIRE(match);
+                REQUIRE(match->handler);
+                CHECK(*match->handler == 2);
+                REQUIRE(match->params.size() == 1);
+                CHECK(match->params[0] == "map1"sv);
+                CHECK(match->params.Query() == "x=1&y=2"sv);
+            }
+        }
+        WHEN("a literal and a parameter share a prefix") {
+            auto list = routes.Find(http::verb::get, "/api/v1/maps/");
+            THEN("trailing slash does not turn into empty parameter") {
+                REQUIRE(list);
+                REQUIRE(list->handler);
+                CHECK(*list->handler == 1);
+            }
+        }
+        WHEN("a known path is requested with a wrong method") {
+            auto match = routes.Find(http::verb::get, "/api/v1/game/join");
+            THEN("no handler but allowed methods are reported") {
+                REQUIRE(match);
+                CHECK_FALSE(match->handler);
+                CHECK(match->allowed_verbs == router::VerbBit(http::verb::post));
+            }
+        }
+        WHEN("HEAD is requested for a GET route") {
+            auto match = routes.Find(http::verb::head, "/api/v1/game/state");
+            THEN("GET handler is used") {
+                REQUIRE(match);
+                REQUIRE(match->handler);
+                CHECK(*match->handler == 5);
+                CHECK(match->head_as_get);
+                CHECK(match->allowed_verbs & router::VerbBit(http::verb::head));
+            }
+        }
+        WHEN("an unknown path is requested") {
+            THEN("nothing is found") {
+                CHECK_FALSE(routes.Find(http::verb::get, "/api/v1/game"));
+                CHECK_FALSE(routes.Find(http::verb::get, "/api/v2/maps"));
+                CHECK_FALSE(routes.Find(http::verb::get, "/api/v1/maps/map1/extra"));
+            }
+        }
+        WHEN("a duplicate route is added") {
+            THEN("registration fails") {
+                CHECK_THROWS_AS(routes.Add(http::verb::get, "/api/v1/maps/{name}", 0), std::invalid_argument);
+            }
+        }
+    }
+}
+
+SCENARIO("query parameters") {
+    CHECK(util::GetQueryParam("start=10&maxItems=5"sv, "maxItems"sv) == "5"sv);
+    CHECK(util::GetQueryParam("start=10&maxItems=5"sv, "start"sv) == "10"sv);
+    CHECK_FALSE(util::GetQueryParam("start=10"sv, "max"sv));
+    CHECK_FALSE(util::GetQueryParam(""sv, "start"sv));
+    CHECK(util::GetQueryParamInt("wait=1"sv, "wait"sv, 0) == 1);
+    CHECK(util::GetQueryParamInt("wait=1"sv, "start"sv, 7) == 7);
+}
+
+// Запуск: game_server_tests "[benchmark]"
+TEST_CASE("route lookup benchmark", "[.][benchmark]") {
+    auto routes = MakeApiRouter();
+
+    // Старая схема: разбиение пути на сегменты и цепочка поиска по std::map на каждом уровне
+    std::map<std::string, std::map<std::string, std::map<std::string, int, std::less<>>, std::less<>>, std::less<>> legacy;
+    legacy["v1"]["game"]["players"] = 4;
+    legacy["v1"]["game"]["state"] = 5;
+    legacy["v1"]["game"]["records"] = 6;
+    legacy["v1"]["maps"][""] = 1;
+
+    constexpr auto target = "/api/v1/game/state?wait=1"sv;
+
+    BENCHMARK("split url + map chain") {
+        auto args = util::SplitUrl(target.substr(0, target.find('?')));
+        args.pop_front();
+        auto version = legacy.find(args.front());
+        args.pop_front();
+        auto group = version->second.find(args.front());
+        args.pop_front();
+        return group->second.find(args.front())->second;
+    };
+
+    BENCHMARK("router find") {
+        return *routes.Find(http::verb::get, target)->handler;
+    };
+}
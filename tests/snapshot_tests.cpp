@@ -0,0 +1,193 @@
+#include <boost/asio/io_context.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include "../src/auto_data_saver.hpp"
+#include "../src/snapshot.h"
+
+using namespace std::literals;
+namespace snapshot = data_serializer::snapshot;
+
+namespace {
+
+snapshot::Snapshot MakeSnapshot() {
+    snapshot::Snapshot result;
+    auto& town = result.sessions.emplace_back();
+    town.map_id = "town"s;
+    town.default_speed = 1.5;
+    town.bag_capacity = 3;
+    town.last_id_object = 7;
+    town.randomize_start = true;
+    town.dogs.push_back({0, "Rex"s, 1.25, -2.5, 0.5, 0, 1.5, 'R', 42, 3, {{1, 2}, {4, 0}}});
+    town.dogs.push_back({1, "Rex"s, 0, 0, 0, 0, 1.5, 'U', 0, 3, {}});
+    town.loot.push_back({5, 1, 3.5, 4});
+
+    auto& map = result.sessions.emplace_back();
+    map.map_id = "map1"s;
+    map.dogs.push_back({2, "Muhtar"s, 10, 20, 0, -1, 2, 'D', 7, 1, {{6, 3}}});
+
+    result.players.push_back({0x0123456789abcdefULL, 0xfedcba9876543210ULL, 0, 1});
+    result.players.push_back({1, 2, 1, 0});
+    return result;
+}
+
+// Файл состояния в том виде, в каком его писали версии сервера до двоичного снимка
+void SaveText(const app::App& app, const std::filesystem::path& path) {
+    std::ofstream out(path, std::ios_base::binary);
+    boost::archive::polymorphic_text_oarchive oa{out};
+    auto size_sessions = app.GetGame().GetSessions().size();
+    oa << size_sessions;
+    for (const auto& session : app.GetGame().GetSessions()) {
+        auto count_dogs = session->GetDogs().size();
+        oa << count_dogs;
+        for (const auto& dog : session->GetDogs()) {
+            data_serializer::DogRepr dog_repr(dog);
+            oa << dog_repr;
+        }
+        auto count_loot = session->GetLootObjects().size();
+        oa << count_loot;
+        for (const auto& loot : session->GetLootObjects()) {
+            data_serializer::LootObjectRepr loot_repr(loot);
+            oa << loot_repr;
+        }
+        data_serializer::GameSessionRepr session_repr(session);
+        oa << session_repr;
+    }
+    auto players_count = app.GetPlayers().GetPlayersList().size();
+    oa << players_count;
+    for (const auto& [token, player] : app.GetPlayers().GetPlayersList()) {
+        std::array<char, util::TOKEN_SIZE> hex;
+        util::TokenToHex(token, hex);
+        data_serializer::PlayerRepr player_repr(std::string(hex.data(), hex.size()), player);
+        oa << player_repr;
+    }
+}
+
+}  // namespace
+
+SCENARIO("binary snapshot") {
+    GIVEN("a game state") {
+        auto state = MakeSnapshot();
+        auto data = snapshot::Encode(state);
+
+        THEN("it is recognized as binary, unlike the text archive") {
+            CHECK(snapshot::IsBinary(data));
+            CHECK_FALSE(snapshot::IsBinary("22 serialization::archive 19 1"sv));
+        }
+
+        THEN("it survives a round trip") {
+            auto loaded = snapshot::Decode(data);
+            REQUIRE(loaded.sessions.size() == 2);
+            const auto& town = loaded.sessions[0];
+            CHECK(town.map_id == "town"s);
+            CHECK(town.default_speed == 1.5);
+            CHECK(town.bag_capacity == 3);
+            CHECK(town.last_id_object == 7);
+            CHECK(town.randomize_start);
+            REQUIRE(town.dogs.size() == 2);
+            CHECK(town.dogs[0].name == "Rex"s);
+            CHECK(town.dogs[0].x == 1.25);
+            CHECK(town.dogs[0].y == -2.5);
+            CHECK(town.dogs[0].speed_x == 0.5);
+            CHECK(town.dogs[0].direction == 'R');
+            CHECK(town.dogs[0].score == 42);
+            CHECK(town.dogs[0].bag == std::vector<std::pair<int, int>>{{1, 2}, {4, 0}});
+            CHECK(town.dogs[1].name == "Rex"s);
+            CHECK(town.dogs[1].bag.empty());
+            REQUIRE(town.loot.size() == 1);
+            CHECK(town.loot[0].id == 5);
+            CHECK(town.loot[0].type == 1);
+            CHECK(town.loot[0].x == 3.5);
+
+            const auto& map = loaded.sessions[1];
+            CHECK(map.map_id == "map1"s);
+            REQUIRE(map.dogs.size() == 1);
+            CHECK(map.dogs[0].id == 2);
+            CHECK(map.dogs[0].direction == 'D');
+            CHECK(map.loot.empty());
+
+            REQUIRE(loaded.players.size() == 2);
+            CHECK(loaded.players[0].token_hi == 0x0123456789abcdefULL);
+            CHECK(loaded.players[0].token_lo == 0xfedcba9876543210ULL);
+            CHECK(loaded.players[0].session == 0);
+            CHECK(loaded.players[0].dog == 1);
+            CHECK(loaded.players[1].session == 1);
+        }
+
+        THEN("repeated names are stored once") {
+            auto unique = state;
+            unique.sessions[0].dogs[1].name = "Sharik"s;
+            CHECK(snapshot::Encode(unique).size() == data.size() + 4 + "Sharik"s.size());
+        }
+
+        THEN("a damaged file is rejected") {
+            auto corrupted = data;
+            corrupted[corrupted.size() / 2] ^= 0x20;
+            CHECK_THROWS_AS(snapshot::Decode(corrupted), std::runtime_error);
+            CHECK_THROWS_AS(snapshot::Decode(std::string_view(data).substr(0, data.size() - 1)), std::runtime_error);
+            CHECK_THROWS_AS(snapshot::Decode(std::string_view(data).substr(0, 10)), std::runtime_error);
+        }
+
+        THEN("a snapshot from a newer server is rejected") {
+            auto newer = data;
+            newer[4] = static_cast<char>(snapshot::VERSION + 1);
+            CHECK_THROWS_AS(snapshot::Decode(newer), std::runtime_error);
+        }
+    }
+
+    GIVEN("an empty game") {
+        auto loaded = snapshot::Decode(snapshot::Encode({}));
+        THEN("nothing is restored") {
+            CHECK(loaded.sessions.empty());
+            CHECK(loaded.players.empty());
+        }
+    }
+}
+
+SCENARIO("text state file from an older server") {
+    GIVEN("a game saved in the text archive format") {
+        const auto config = CMAKE_BIN_PATH + "/../../data/config.json"s;
+        const auto path = std::filesystem::temp_directory_path() / "snapshot_text_test.save";
+        boost::asio::io_context ioc;
+
+        app::App saved(config, {}, ioc.get_executor());
+        auto [rex, rex_token] = saved.GetMutablePlayers().AddPlayer("Rex"sv, model::Map::Id("map1"s));
+        rex->dog_->SetPosition({1.25, 2.5});
+        rex->dog_->SetScore(42);
+        rex->dog_->SetBag({{{1, 2}}, 3});
+        auto [muhtar, muhtar_token] = saved.GetMutablePlayers().AddPlayer("Muhtar"sv, model::Map::Id("map1"s));
+        SaveText(saved, path);
+
+        WHEN("a new server loads it") {
+            app::App loaded(config, {}, ioc.get_executor());
+            data_serializer::DataSaver(&loaded, path.string()).Load();
+
+            THEN("sessions are restored") {
+                REQUIRE(loaded.GetGame().GetSessions().size() == 1);
+                const auto& session = loaded.GetGame().GetSessions()[0];
+                CHECK(*session->GetMap()->GetId() == "map1"s);
+                CHECK(session->GetDogs().size() == 2);
+            }
+
+            THEN("players are found by their old tokens") {
+                CHECK(loaded.GetPlayers().GetPlayersList().size() == 2);
+                auto player = loaded.GetPlayers().FindByToken(rex_token);
+                REQUIRE(player);
+                CHECK(player->dog_->GetName() == "Rex"s);
+                CHECK(player->dog_->GetPosition().x == 1.25);
+                CHECK(player->dog_->GetPosition().y == 2.5);
+                CHECK(player->dog_->GetScore() == 42);
+                CHECK(player->dog_->GetBag().items == std::vector<std::pair<int, int>>{{1, 2}});
+                CHECK(player->session_ == loaded.GetGame().GetSessions()[0]);
+
+                auto other = loaded.GetPlayers().FindByToken(muhtar_token);
+                REQUIRE(other);
+                CHECK(other->dog_->GetName() == "Muhtar"s);
+                CHECK(other->session_ == player->session_);
+            }
+        }
+        std::filesystem::remove(path);
+    }
+}
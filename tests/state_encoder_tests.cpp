@@ -0,0 +1,83 @@
+#include <cstring>
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/state_encoder.h"
+
+using namespace std::literals;
+
+namespace {
+
+uint32_t ReadU32(const std::string& data, size_t offset) {
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; --i) 
+        value = (value << 8) | static_cast<unsigned char>(data[offset + i]);
+    return value;
+}
+
+float ReadF32(const std::string& data, size_t offset) {
+    auto bits = ReadU32(data, offset);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+}  // namespace
+
+SCENARIO("binary state encoding") {
+    GIVEN("a session with one dog") {
+        auto map = std::make_shared<model::Map>(model::Map::Id(""),"");
+        map->LoadJsonFromFile(CMAKE_BIN_PATH + "/../../data/test_config.json"s);
+        auto loot_generator = std::make_shared<loot_gen::LootGenerator>(std::chrono::milliseconds(1000), 0.0f);
+        model::TimeManager time_manager;
+        auto session = std::make_shared<model::GameSession>(map, time_manager, 1.0, 3, false, 60, loot_generator);
+        auto dog = session->AddDog("dog");
+        dog->SetPosition({1.5, 2.0});
+        dog->SetScore(42);
+        dog->SetBag({{{7, 1}}, 3});
+
+        WHEN("state is encoded") {
+            auto data = api_v1::EncodeStateBinary(*session);
+
+            THEN("layout is fixed little-endian") {
+                REQUIRE(data.size() == 8 + 32 + 8 + 4);
+                CHECK(data.substr(0, 4) == "DST2"s);
+                CHECK(ReadU32(data, 4) == 1);
+                CHECK(ReadU32(data, 8) == *dog->GetId());
+                CHECK(ReadF32(data, 12) == 1.5f);
+                CHECK(ReadF32(data, 16) == 2.0f);
+                CHECK(data[28] == 'U');
+                CHECK(ReadU32(data, 32) == 42);
+                CHECK(ReadU32(data, 36) == 1);
+                CHECK(ReadU32(data, 40) == 7);
+                CHECK(ReadU32(data, 44) == 1);
+                CHECK(ReadU32(data, 48) == 0);
+            }
+        }
+        WHEN("the bag holds more than 255 items") {
+            std::vector<std::pair<int, int>> items;
+            for (int i = 0; i < 300; ++i) 
+                items.emplace_back(i, 0);
+            dog->SetBag({items, 300});
+            auto data = api_v1::EncodeStateBinary(*session);
+
+            THEN("the count is not truncated and the loot list follows the bag") {
+                REQUIRE(data.size() == 8 + 32 + 300 * 8 + 4);
+                CHECK(ReadU32(data, 36) == 300);
+                CHECK(ReadU32(data, 40 + 299 * 8) == 299);
+                CHECK(ReadU32(data, 40 + 300 * 8) == 0);
+            }
+        }
+        WHEN("client asks for octet-stream") {
+            CHECK(api_v1::NegotiateStateFormat("application/octet-stream"sv) == api_v1::StateFormat::BINARY);
+            CHECK(api_v1::NegotiateStateFormat("application/json, */*"sv) == api_v1::StateFormat::JSON);
+            CHECK(api_v1::NegotiateStateFormat(""sv) == api_v1::StateFormat::JSON);
+            CHECK(api_v1::NegotiateStateFormat("Application/Octet-Stream;q=0.9, application/json;q=0.5"sv) == api_v1::StateFormat::BINARY);
+            CHECK(api_v1::NegotiateStateFormat("application/octet-stream;q=0.5, application/json"sv) == api_v1::StateFormat::JSON);
+        }
+        WHEN("octet-stream is explicitly refused") {
+            CHECK(api_v1::NegotiateStateFormat("application/octet-stream;q=0, */*"sv) == api_v1::StateFormat::JSON);
+            CHECK(api_v1::NegotiateStateFormat("application/octet-stream; q=0.0"sv) == api_v1::StateFormat::JSON);
+            CHECK(api_v1::NegotiateStateFormat("application/octet-stream-x"sv) == api_v1::StateFormat::JSON);
+        }
+    }
+}
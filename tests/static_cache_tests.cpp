@@ -0,0 +1,60 @@
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+
+#include "../src/static_cache.h"
+
+using namespace std::literals;
+namespace fs = std::filesystem;
+namespace http = boost::beast::http;
+
+SCENARIO("static file cache") {
+    GIVEN("a www-root with one file") {
+        auto root = fs::temp_directory_path() / "static_cache_test";
+        fs::remove_all(root);
+        fs::create_directories(root / "js");
+        std::ofstream(root / "js" / "app.js") << "console.log(1);";
+
+        http_handler::StaticCache cache(root.string());
+
+        THEN("the file is cached with precomputed headers") {
+            CHECK(cache.size() == 1);
+            auto entry = cache.Find("/js/app.js"sv);
+            REQUIRE(entry);
+            CHECK(*entry->Raw().data == "console.log(1);"s);
+            CHECK(entry->content_type == "text/javascript"s);
+            CHECK(entry->Raw().etag.size() == 18);
+            CHECK(entry->last_modified.ends_with(" GMT"));
+            CHECK_FALSE(cache.Find("/js/other.js"sv));
+        }
+
+        WHEN("a client repeats the request with the etag") {
+            auto entry = cache.Find("/js/app.js"sv);
+            REQUIRE(entry);
+
+            StringRequest req(http::verb::get, "/js/app.js", 11);
+            auto first = http_handler::StaticCache::MakeResponse(*entry, req);
+            req.set(http::field::if_none_match, first[http::field::etag]);
+            auto second = http_handler::StaticCache::MakeResponse(*entry, req);
+
+            THEN("the second response is 304 without body") {
+                CHECK(first.result() == http::status::ok);
+                CHECK(first.body() == entry->Raw().data);
+                CHECK(second.result() == http::status::not_modified);
+                CHECK_FALSE(second.body());
+            }
+        }
+
+        WHEN("If-Modified-Since matches Last-Modified") {
+            auto entry = cache.Find("/js/app.js"sv);
+            REQUIRE(entry);
+            StringRequest req(http::verb::get, "/js/app.js", 11);
+            req.set(http::field::if_modified_since, entry->last_modified);
+            THEN("the response is 304") {
+                CHECK(http_handler::StaticCache::MakeResponse(*entry, req).result() == http::status::not_modified);
+            }
+        }
+
+        fs::remove_all(root);
+    }
+}
@@ -0,0 +1,38 @@
+#include <catch2/catch_test_macros.hpp>
+#include <set>
+
+#include "../src/token_minter.h"
+
+SCENARIO("chacha20 keystream") {
+    GIVEN("key and nonce from RFC 8439, section 2.3.2") {
+        util::ChaCha20Rng::Key key;
+        for (uint32_t i = 0; i < key.size(); ++i)
+            key[i] = (4 * i) | ((4 * i + 1) << 8) | ((4 * i + 2) << 16) | ((4 * i + 3) << 24);
+        // 32-битный счетчик 1 и 96-битный nonce 00000009 0000004a 00000000 в раскладке 64/64
+        util::ChaCha20Rng rng(key, 1 | (uint64_t(0x09000000) << 32), 0x4a000000);
+
+        THEN("output matches the reference block") {
+            const uint8_t expected[16] = {0x10, 0xf1, 0xe7, 0xe4, 0xd1, 0x3b, 0x59, 0x15,
+                                          0x50, 0x0f, 0xdd, 0x1f, 0xa3, 0x20, 0x71, 0xc4};
+            uint8_t out[16];
+            rng.Fill(out, sizeof(out));
+            for (size_t i = 0; i < sizeof(out); ++i)
+                CHECK(out[i] == expected[i]);
+        }
+    }
+}
+
+SCENARIO("token minting") {
+    auto& minter = util::TokenMinter::ThreadLocal();
+
+    std::set<util::Token> tokens;
+    for (size_t i = 0; i < util::TokenMinter::BATCH_SIZE * 3; ++i)
+        tokens.insert(minter.Mint());
+    CHECK(tokens.size() == util::TokenMinter::BATCH_SIZE * 3);
+
+    auto uuid = minter.MintUuid();
+    REQUIRE(uuid.size() == 36);
+    CHECK(uuid[8] == '-');
+    CHECK(uuid[14] == '4');
+    CHECK((uuid[19] == '8' || uuid[19] == '9' || uuid[19] == 'a' || uuid[19] == 'b'));
+}
@@ -0,0 +1,101 @@
+#include <catch2/catch_test_macros.hpp>
+#include <map>
+#include <random>
+
+#include "../src/error_codes.h"
+#include "../src/token_table.h"
+
+using namespace std::literals;
+
+namespace {
+
+util::Token MakeToken(uint64_t hi, uint64_t lo) { return util::Token(util::TokenBits{hi, lo}); }
+
+}  // namespace
+
+SCENARIO("token hex conversion") {
+    auto token = util::ParseTokenHex("0123456789abcdefFEDCBA9876543210"sv);
+    REQUIRE(token);
+    CHECK((**token).hi == 0x0123456789abcdefull);
+    CHECK((**token).lo == 0xfedcba9876543210ull);
+    std::array<char, util::TOKEN_SIZE> hex;
+    util::TokenToHex(*token, hex);
+    CHECK(std::string_view(hex.data(), hex.size()) == "0123456789abcdeffedcba9876543210"sv);
+
+    CHECK_FALSE(util::ParseTokenHex("0123456789abcdef"sv));
+    CHECK_FALSE(util::ParseTokenHex("0123456789abcdefFEDCBA987654321z"sv));
+    CHECK(util::CreateTokenByAuthorizationString("Bearer 0123456789abcdeffedcba9876543210"sv) == *token);
+
+    // Неверная длина - invalidToken, 32 символа не из hex - unknownToken, как было до разбора в число
+    try {
+        util::CreateTokenByAuthorizationString("Bearer 0123"sv);
+        FAIL("token is too short");
+    } catch (http_handler::ErrorCode code) {
+        CHECK(code == http_handler::ErrorCode::AUTHORIZATION_NOT_EXIST);
+    }
+    try {
+        util::CreateTokenByAuthorizationString("Bearer 0123456789abcdefFEDCBA987654321z"sv);
+        FAIL("token is not hex");
+    } catch (http_handler::ErrorCode code) {
+        CHECK(code == http_handler::ErrorCode::AUTHORIZATION_NOT_FOUND);
+    }
+}
+
+SCENARIO("token table") {
+    GIVEN("an empty table") {
+        util::TokenTable<int> table;
+
+        WHEN("values are inserted") {
+            table.Insert(MakeToken(1, 2), 10);
+            table.Insert(MakeToken(3, 4), 20);
+            THEN("they can be found") {
+                CHECK(table.size() == 2);
+                REQUIRE(table.Find(MakeToken(1, 2)));
+                CHECK(*table.Find(MakeToken(1, 2)) == 10);
+                CHECK_FALSE(table.Find(MakeToken(2, 1)));
+            }
+            AND_WHEN("a value is erased") {
+                CHECK(table.Erase(MakeToken(1, 2)));
+                THEN("only the other one remains") {
+                    CHECK(table.size() == 1);
+                    CHECK_FALSE(table.Find(MakeToken(1, 2)));
+                    CHECK(table.Find(MakeToken(3, 4)));
+                    CHECK_FALSE(table.Erase(MakeToken(1, 2)));
+                }
+            }
+        }
+    }
+
+    GIVEN("random inserts and erases") {
+        util::TokenTable<uint64_t> table;
+        std::map<std::pair<uint64_t, uint64_t>, uint64_t> reference;
+        std::mt19937_64 random(42);
+
+        for (int i = 0; i < 20000; ++i) {
+            // Узкий диапазон, чтобы чаще попадать в уже существующие ключи
+            uint64_t hi = random() % 512;
+            uint64_t lo = random() % 8;
+            if (random() % 3 == 0) {
+                CHECK(table.Erase(MakeToken(hi, lo)) == (reference.erase({hi, lo}) == 1));
+            } else {
+                table.Insert(MakeToken(hi, lo), i);
+                reference[{hi, lo}] = i;
+            }
+        }
+
+        THEN("table matches the reference map") {
+            REQUIRE(table.size() == reference.size());
+            for (const auto& [key, value] : reference) {
+                auto found = table.Find(MakeToken(key.first, key.second));
+                REQUIRE(found);
+                CHECK(*found == value);
+            }
+            size_t iterated = 0;
+            for (const auto& [token, value] : table) {
+                CHECK(reference.at({(*token).hi, (*token).lo}) == value);
+                ++iterated;
+            }
+            CHECK(iterated == reference.size());
+        }
+    }
+}
@@ -0,0 +1,112 @@
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+
+#include "../src/use_case_impl_memory.h"
+
+using namespace std::literals;
+
+namespace {
+
+std::vector<std::string> Names(const app::UseCases::players_list_t& players) {
+    std::vector<std::string> names;
+    for (const auto& player : players)
+        names.push_back(player.name_);
+    return names;
+}
+
+std::vector<std::string> Ids(const app::UseCases::players_list_t& players) {
+    std::vector<std::string> ids;
+    for (const auto& player : players)
+        ids.push_back(player.id_);
+    return ids;
+}
+
+}  // namespace
+
+SCENARIO("in-memory records") {
+    GIVEN("retired players") {
+        app::UseCasesMemory records;
+        records.AddPlayerRetired({"b", 10, 2000});
+        records.AddPlayerRetired({"a", 10, 2000});
+        records.AddPlayerRetired({"c", 20, 5000});
+        records.AddPlayerRetired({"d", 10, 1000});
+        records.AddPlayerRetired({"d", 10, 1000});
+
+        THEN("they are sorted like the database query") {
+            CHECK(Names(records.GetPlayersRetired(0, 100)) == std::vector{"c"s, "d"s, "d"s, "a"s, "b"s});
+            CHECK(Names(records.GetPlayersRetired(3, 1)) == std::vector{"a"s});
+            CHECK(records.GetPlayersRetired(10, 1).empty());
+        }
+        THEN("a cursor continues strictly after its row") {
+            auto first_d = records.GetPlayersRetired(1, 1).front();
+            CHECK(Names(records.GetPlayersRetiredAfter(first_d, 100)) == std::vector{"d"s, "a"s, "b"s});
+            CHECK(Names(records.GetPlayersRetiredAfter(records.GetPlayersRetired(2, 1).front(), 100)) == std::vector{"a"s, "b"s});
+            CHECK(Names(records.GetPlayersRetiredAfter(records.GetPlayersRetired(0, 1).front(), 1)) == std::vector{"d"s});
+        }
+    }
+
+    GIVEN("a records file") {
+        auto path = std::filesystem::temp_directory_path() / "records_memory_test.tsv";
+        std::filesystem::remove(path);
+        {
+            app::UseCasesMemory records(path);
+            records.AddPlayerRetired({"Rex\t\"the\\dog\"\n", 5, 100});
+            records.AddPlayerRetired({"Bob", 7, 200});
+        }
+        {
+            std::ofstream torn(path, std::ios::app);
+            torn << "9\t30";
+        }
+        WHEN("the server starts again") {
+            app::UseCasesMemory records(path);
+            THEN("complete records are restored and the torn line is skipped") {
+                REQUIRE(records.Size() == 2);
+                auto players = records.GetPlayersRetired(0, 10);
+                CHECK(players[0].name_ == "Bob");
+                CHECK(players[1].name_ == "Rex\t\"the\\dog\"\n");
+                CHECK(players[1].play_time_ms_ == 100);
+            }
+            THEN("record ids survive the restart") {
+                auto ids = Ids(records.GetPlayersRetired(0, 10));
+                CHECK(ids.front().size() == 36);
+                CHECK(ids == Ids(app::UseCasesMemory(path).GetPlayersRetired(0, 10)));
+            }
+            AND_WHEN("more players retire") {
+                records.AddPlayerRetired({"Max", 1, 300});
+                THEN("they are not glued to the torn line") {
+                    app::UseCasesMemory reloaded(path);
+                    CHECK(reloaded.Size() == 3);
+                }
+            }
+        }
+        std::filesystem::remove(path);
+    }
+
+    GIVEN("a records file torn in the middle of a name") {
+        auto path = std::filesystem::temp_directory_path() / "records_memory_name_test.tsv";
+        std::filesystem::remove(path);
+        {
+            app::UseCasesMemory records(path);
+            records.AddPlayerRetired({"Bob", 7, 200});
+        }
+        {
+            std::ofstream torn(path, std::ios::app);
+            torn << "9\t30\tBo";
+        }
+        WHEN("the server starts again") {
+            app::UseCasesMemory records(path);
+            THEN("the torn record is not loaded with a cut name") {
+                CHECK(Names(records.GetPlayersRetired(0, 10)) == std::vector{"Bob"s});
+            }
+            AND_WHEN("more players retire") {
+                records.AddPlayerRetired({"Max", 1, 300});
+                THEN("the torn record does not come back on the next start") {
+                    app::UseCasesMemory reloaded(path);
+                    CHECK(Names(reloaded.GetPlayersRetired(0, 10)) == std::vector{"Bob"s, "Max"s});
+                }
+            }
+        }
+        std::filesystem::remove(path);
+    }
+}